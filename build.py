@@ -14,6 +14,7 @@ def build_linux():
             + "&& cmake "
             + "-DCMAKE_BUILD_TYPE=Release "
             + "-DLLVM_TARGETS_TO_BUILD=X86 "
+            + "-DLLVM_ENABLE_PROJECTS=lld "
             + "-DCMAKE_INSTALL_PREFIX=build/debug/llvm/installed "
             + "-DLLVM_ENABLE_TERMINFO=OFF "
             + "-DLLVM_ENABLE_RTTI=ON "
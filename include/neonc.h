@@ -3,8 +3,14 @@
 // precompiled header file
 
 #include <llvm/ADT/APFloat.h>
+#include <llvm/ADT/APInt.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/ADT/STLExtras.h>
 #include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/Allocator.h>
 
 #include <llvm/IR/GlobalValue.h>
 #include <llvm/IR/BasicBlock.h>
@@ -20,10 +26,24 @@
 #include <llvm/IR/Verifier.h>
 #include <llvm/IR/PassManager.h>
 
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+
+#include <llvm/Object/ArchiveWriter.h>
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/TargetProcess/TargetExecutionUtils.h>
+
+#include <lld/Common/Driver.h>
+
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/MC/MCSubtargetInfo.h>
 
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/xxhash.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
 
@@ -46,6 +66,7 @@
 #include <llvm/Transforms/Scalar/SCCP.h>
 #include <llvm/Transforms/Scalar/CorrelatedValuePropagation.h>
 #include <llvm/Transforms/Scalar/LICM.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
 
 #include <numeric>
 #include <chrono>
@@ -54,16 +75,27 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
 #include <optional>
 #include <tuple>
+#include <variant>
 #include <fstream>
 #include <ostream>
 #include <sstream>
 #include <cstddef>
+#include <cstring>
 #include <regex>
 #include <cstdint>
 #include <map>
 #include <algorithm>
 #include <utility>
 #include <list>
+#include <deque>
+#include <iomanip>
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
@@ -0,0 +1,554 @@
+#include <neonc/lexer/lexer.h>
+#include <neonc/parser/parser.h>
+#include <neonc/llvm/target.h>
+#include <neonc/parser/grammar.h>
+
+#include <random>
+
+// every allocation of the process is counted, so that the parser can be checked to consume tokens without any
+namespace {
+    std::size_t allocations = 0;
+}
+
+void * operator new(const std::size_t size) {
+    allocations++;
+
+    if (void * memory = std::malloc(size ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void * memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void * memory, const std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+    // ~bytes of representative neon source, long identifiers, indentation runs, numbers and strings
+    std::string generate_source(const std::size_t bytes) {
+        std::string source;
+        source.reserve(bytes + 256);
+
+        for (uint32_t i = 0; source.size() < bytes; i++) {
+            const auto n = std::to_string(i);
+
+            source += "fn generated_function_" + n + "(first_argument, second_argument: i32) i32 {\n";
+            source += "    var accumulated_value_" + n + " = first_argument * 1_000 + second_argument - " + n + "\n";
+            source += "    var scaled_" + n + ": f32 = 3.14159 * 2.5\n";
+            source += "    var message_" + n + " = \"generated function number " + n + " with a longer string\"\n";
+            source += "    helper_call(accumulated_value_" + n + ", 42, 1_024)\n";
+            source += "    return accumulated_value_" + n + "\n";
+            source += "}\n\n";
+        }
+
+        return source;
+    }
+
+    // functions returning one long expression each, mixed precedence, prefix operators and parentheses
+    std::string generate_expressions(const uint32_t functions, const uint32_t terms) {
+        const char * ops[] = { " + ", " * ", " - ", " / ", " << ", " & ", " | ", " % " };
+
+        std::string source;
+
+        for (uint32_t f = 0; f < functions; f++) {
+            source += "fn expression_" + std::to_string(f) + "(a, b: i32) i32 {\n    return a";
+
+            for (uint32_t i = 1; i < terms; i++) {
+                source += ops[i % 8];
+
+                if (i % 7 == 0) {
+                    source += "(b - " + std::to_string(i) + ")";
+                } else if (i % 5 == 0) {
+                    source += "-a";
+                } else {
+                    source += i % 2 ? "b" : std::to_string(i);
+                }
+            }
+
+            source += "\n}\n\n";
+        }
+
+        return source;
+    }
+
+    // functions whose variables are initialized by calls to other functions and by each other, with `unique`
+    // every function names its variables differently, so the program has as many names as variables
+    std::string generate_calls(const uint32_t functions, const uint32_t variables, const bool unique = false) {
+        std::string source;
+
+        for (uint32_t f = 0; f < functions; f++) {
+            const auto v = [&](const uint32_t index) {
+                return (unique ? "f" + std::to_string(f) + "_v" : std::string("v")) + std::to_string(index);
+            };
+
+            source += "fn call_" + std::to_string(f) + "(a: i32) i32 {\n    var " + v(0) + " = call_" + std::to_string((f * 7 + 3) % functions) + "(a)\n";
+
+            for (uint32_t i = 1; i < variables; i++)
+                source += "    var " + v(i) + " = " + v(i - 1) + " + a * " + std::to_string(i) + "\n";
+
+            source += "    return " + v(variables - 1) + "\n}\n\n";
+        }
+
+        return source;
+    }
+
+    bool same_tokens(const neonc::TokenBuffer & a, const neonc::TokenBuffer & b) {
+        if (a.size() != b.size())
+            return false;
+
+        for (uint32_t i = 0; i < a.size(); i++) {
+            if (
+                a.kind(i) != b.kind(i)
+                || a.newline_before(i) != b.newline_before(i)
+                || a.offset(i) != b.offset(i)
+                || a.length(i) != b.length(i)
+                || a.value(i) != b.value(i)
+                || (a.kind(i) == neonc::TokenId::IDENT && a.symbol(i) != b.symbol(i))
+            )
+                return false;
+        }
+
+        return true;
+    }
+
+    bool same_tree(neonc::AbstractSyntaxTree & a, neonc::AbstractSyntaxTree & b) {
+        const auto & x = a.get_tree();
+        const auto & y = b.get_tree();
+
+        if (x.size() != y.size())
+            return false;
+
+        for (uint32_t i = 0; i < x.size(); i++) {
+            if (x.tag(i) != y.tag(i) || x.location(i).raw != y.location(i).raw || x.end(i) != y.end(i))
+                return false;
+        }
+
+        return true;
+    }
+
+    template<typename F>
+    double best_seconds(const uint32_t runs, F && f) {
+        double best = std::numeric_limits<double>::max();
+
+        for (uint32_t i = 0; i < runs; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            f();
+            const auto end = std::chrono::steady_clock::now();
+
+            best = std::min(best, std::chrono::duration<double>(end - start).count());
+        }
+
+        return best;
+    }
+
+    void bench_lexer(const std::size_t megabytes, const uint32_t runs) {
+        const auto source = generate_source(megabytes * 1024 * 1024);
+        const auto file = neonc::source_manager().add("<bench>", source);
+        const auto lexer = neonc::Lexer();
+        const double mb = double(source.size()) / (1024.0 * 1024.0);
+
+        std::cout << "lexer: " << mb << " MB, best of " << runs << std::endl;
+
+        double scalar = 0;
+
+        for (auto isa : { neonc::ScanIsa::Scalar, neonc::ScanIsa::SSE42, neonc::ScanIsa::AVX2 }) {
+            if (isa > neonc::detect_scan_isa())
+                continue;
+
+            neonc::use_scan_isa(isa);
+
+            std::size_t count = 0;
+            const double seconds = best_seconds(runs, [&] {
+                count = lexer.Tokenize(file).size();
+            });
+
+            if (isa == neonc::ScanIsa::Scalar)
+                scalar = seconds;
+
+            std::cout << "    " << std::setw(8) << std::left << isa
+                << std::setw(10) << std::right << std::fixed << std::setprecision(1) << mb / seconds << " MB/s"
+                << "  x" << std::setprecision(2) << scalar / seconds
+                << "  (" << count << " tokens)" << std::endl;
+        }
+
+        neonc::use_scan_isa(neonc::detect_scan_isa());
+
+        {
+            std::size_t count = 0;
+            const double seconds = best_seconds(runs, [&] {
+                auto stream = neonc::TokenStream(file);
+
+                for (count = 0; stream.buffer().kind(stream.fetch(count)) != neonc::TokenId::ENDOFFILE; count++) {}
+
+                count++;
+            });
+
+            std::cout << "    " << std::setw(8) << std::left << "stream"
+                << std::setw(10) << std::right << std::fixed << std::setprecision(1) << mb / seconds << " MB/s"
+                << "  x" << std::setprecision(2) << scalar / seconds
+                << "  (" << count << " tokens, window of " << neonc::TokenStream::BATCH << ")" << std::endl;
+        }
+
+        const auto sequential = neonc::Lexer(1).Tokenize(file);
+        const uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+
+        for (uint32_t threads : { 2u, 4u, hardware }) {
+            const auto parallel = neonc::Lexer(threads, 0);
+
+            std::size_t count = 0;
+            const double seconds = best_seconds(runs, [&] {
+                count = parallel.Tokenize(file).size();
+            });
+
+            std::cout << "    " << std::setw(8) << std::left << (std::to_string(threads) + "t")
+                << std::setw(10) << std::right << std::fixed << std::setprecision(1) << mb / seconds << " MB/s"
+                << "  x" << std::setprecision(2) << scalar / seconds
+                << "  (" << count << " tokens, " << (same_tokens(sequential, parallel.Tokenize(file)) ? "identical" : "MISMATCH") << ")" << std::endl;
+        }
+    }
+
+    // random edits relexed in place must give the tokens and lines of lexing the edited text from scratch,
+    // then typing into files of growing size, time per edit stays flat as long as relexing is local, false if
+    // any tokens differ
+    bool bench_relex(const uint32_t edits) {
+        const auto lexer = neonc::Lexer(1);
+        std::mt19937 random(42);
+
+        auto pick = [&](const uint32_t low, const uint32_t high) {
+            return std::uniform_int_distribution<uint32_t>(low, high)(random);
+        };
+
+        std::cout << "relex: " << edits << " edits, best of 3" << std::endl;
+
+        bool passed = true;
+
+        {
+            // no braces, the full lexer checks them and relexing does not, escapes make boxed literals come and go
+            const std::string_view alphabet = "abnz_019 .+*\"\\\n\n";
+
+            std::string text = generate_source(64 * 1024);
+            const auto file = neonc::source_manager().add("<relex>", text);
+
+            auto tokens = lexer.Tokenize(file);
+            bool identical = true;
+
+            for (uint32_t i = 0; i < edits && identical; i++) {
+                const uint32_t offset = pick(0, text.size());
+                const uint32_t length = pick(0, std::min<uint32_t>(8, text.size() - offset));
+
+                std::string inserted;
+
+                for (uint32_t n = pick(0, 8); n > 0; n--)
+                    inserted += alphabet[pick(0, alphabet.size() - 1)];
+
+                text.replace(offset, length, inserted);
+
+                identical = lexer.Relex(tokens, { offset, length, inserted }).has_value()
+                    && neonc::source_manager().buffer(file) == text
+                    && same_tokens(tokens, lexer.Tokenize(file));
+
+                if (identical && i % 20 == 0) {
+                    const auto fresh = neonc::source_manager().add("<relex>", text);
+
+                    identical = neonc::source_manager().line_count(file) == neonc::source_manager().line_count(fresh);
+
+                    for (uint32_t n = 0; n < 16 && identical; n++) {
+                        const uint32_t at = pick(0, text.size());
+                        const auto a = neonc::source_manager().position(file, at);
+                        const auto b = neonc::source_manager().position(fresh, at);
+
+                        identical = a.line == b.line && a.column == b.column;
+                    }
+                }
+            }
+
+            std::cout << "    " << std::setw(8) << std::left << "random"
+                << "  (" << (identical ? "identical" : "MISMATCH") << ")" << std::endl;
+
+            passed &= identical;
+        }
+
+        {
+            // an edit outside of the file is refused, one that breaks a literal is reported once
+            const auto file = neonc::source_manager().add("<relex>", "fn f() {\n    var s = \"ok\"\n}\n");
+            auto tokens = lexer.Tokenize(file);
+
+            neonc::diagnostics().clear();
+
+            const bool refused = !lexer.Relex(tokens, { neonc::source_manager().size(file) + 1, 0, "x" });
+            const bool relexed = lexer.Relex(tokens, { 22, 0, "\\q" }).has_value();
+            const bool reported = neonc::diagnostics().error_count() == 1;
+
+            neonc::diagnostics().clear();
+
+            std::cout << "    " << std::setw(8) << std::left << "errors"
+                << "  (" << (refused && relexed && reported ? "ok" : "FAILED") << ")" << std::endl;
+
+            passed &= refused && relexed && reported;
+        }
+
+        double smallest = 0;
+
+        for (uint32_t megabytes : { 1u, 4u, 16u }) {
+            const auto file = neonc::source_manager().add("<relex>", generate_source(megabytes * 1024 * 1024));
+            auto tokens = lexer.Tokenize(file);
+            const uint32_t size = neonc::source_manager().size(file);
+
+            // the first edit that adds a token takes the file and its tokens over, which costs their size once
+            lexer.Relex(tokens, { 0, 0, "x\n" });
+
+            uint32_t cursor = size / 2;
+
+            std::string at;
+            bool accepted = true;
+
+            // a cursor walking a few bytes at a time, typing and deleting, never across a quote
+            const double seconds = best_seconds(3, [&] {
+                for (uint32_t i = 0; i < edits; i++) {
+                    cursor = std::clamp<int64_t>(int64_t(cursor) + pick(0, 16) - 8, 0, neonc::source_manager().size(file) - 1);
+
+                    at.clear();
+                    neonc::source_manager().copy(file, cursor, cursor + 1, at);
+
+                    const bool erase = i % 3 == 2 && at[0] != '\"';
+
+                    accepted &= lexer.Relex(tokens, { cursor, erase, erase ? "" : "x" }).has_value();
+                }
+            });
+
+            const double per_edit = seconds * 1e6 / edits;
+
+            if (smallest == 0)
+                smallest = per_edit;
+
+            const bool identical = accepted && same_tokens(tokens, lexer.Tokenize(file));
+
+            std::cout << "    " << std::setw(8) << std::left << (std::to_string(megabytes) + " MB")
+                << std::setw(10) << std::right << std::fixed << std::setprecision(1) << per_edit << " us/edit"
+                << "  x" << std::setprecision(2) << per_edit / smallest
+                << "  (" << (identical ? "identical" : "MISMATCH") << (per_edit > smallest * 4 ? ", GROWING" : "") << ")" << std::endl;
+
+            passed &= identical;
+        }
+
+        return passed;
+    }
+
+    // consumes every token of a buffer through accept and expect, which must not allocate at all, false if they do
+    bool bench_tokens(const uint32_t functions, const uint32_t terms) {
+        const auto file = neonc::source_manager().add("<bench>", generate_expressions(functions, terms));
+        const auto tokens = neonc::Lexer(1).Tokenize(file);
+
+        auto pack = neonc::Pack(tokens);
+        uint32_t consumed = 0;
+
+        const auto before = allocations;
+
+        while (pack.get() != neonc::TokenId::ENDOFFILE) {
+            const auto token = consumed % 2
+                ? neonc::accept(&pack, pack.get(), neonc::TokenId::NEWLINE)
+                : neonc::expect(&pack, pack.get(), neonc::TokenId::NEWLINE, "expected the token just peeked");
+
+            consumed += token.has_value();
+        }
+
+        const auto allocated = allocations - before;
+
+        std::cout << "tokens: " << consumed << " accepted" << std::endl;
+        std::cout << "    " << std::setw(8) << std::left << "buffer"
+            << std::setw(10) << std::right << std::fixed << std::setprecision(1) << double(allocated) / consumed << " allocs/token"
+            << "  (" << (allocated == 0 && consumed + 1 == tokens.size() ? "ok" : "FAILED") << ")" << std::endl;
+
+        return allocated == 0 && consumed + 1 == tokens.size();
+    }
+
+    void bench_parser(const uint32_t functions, const uint32_t terms, const uint32_t runs) {
+        const auto source = generate_expressions(functions, terms);
+        const auto file = neonc::source_manager().add("<bench>", source);
+        const auto tokens = neonc::Lexer(1).Tokenize(file);
+        const auto parser = neonc::Parser(1);
+        const double mb = double(source.size()) / (1024.0 * 1024.0);
+
+        std::cout << "parser: " << functions << " expressions of " << terms << " terms, best of " << runs << std::endl;
+
+        const double scalar = best_seconds(runs, [&] {
+            parser.parse_ast(tokens);
+        });
+
+        std::cout << "    " << std::setw(8) << std::left << "expr"
+            << std::setw(10) << std::right << std::fixed << std::setprecision(1) << mb / scalar << " MB/s"
+            << "  (" << std::setprecision(1) << double(functions) * terms / scalar / 1e6 << " M terms/s, "
+            << tokens.size() << " tokens)" << std::endl;
+
+        auto sequential = parser.parse_ast(tokens);
+        const uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+
+        for (uint32_t threads : { 2u, 4u, hardware }) {
+            const auto parallel = neonc::Parser(threads, 0);
+
+            const double seconds = best_seconds(runs, [&] {
+                parallel.parse_ast(tokens);
+            });
+
+            auto ast = parallel.parse_ast(tokens);
+
+            std::cout << "    " << std::setw(8) << std::left << (std::to_string(threads) + "t")
+                << std::setw(10) << std::right << std::fixed << std::setprecision(1) << mb / seconds << " MB/s"
+                << "  x" << std::setprecision(2) << scalar / seconds
+                << "  (" << (same_tree(sequential, ast) ? "identical" : "MISMATCH") << ")" << std::endl;
+        }
+    }
+
+    // verifies fresh trees of growing size, time per node stays flat as long as analysis is linear, also when
+    // every function brings names of its own
+    void bench_analyzer(const uint32_t variables, const uint32_t runs) {
+        std::cout << "analyzer: functions of " << variables << " variables, best of " << runs << std::endl;
+
+        for (const bool unique : { false, true })
+        for (uint32_t functions : { 1000u, 4000u, 16000u }) {
+            const auto file = neonc::source_manager().add("<bench>", generate_calls(functions, variables, unique));
+            const auto tokens = neonc::Lexer(1).Tokenize(file);
+            const auto parser = neonc::Parser(1);
+
+            std::vector<std::unique_ptr<neonc::AbstractSyntaxTree>> trees;
+
+            // flattened outside of the timed runs, inference fills in types so every run needs its own tree
+            for (uint32_t i = 0; i < runs; i++) {
+                trees.push_back(std::unique_ptr<neonc::AbstractSyntaxTree>(new neonc::AbstractSyntaxTree(parser.parse_ast(tokens))));
+                trees.back()->get_tree();
+            }
+
+            uint32_t run = 0;
+            bool verified = true;
+
+            const double seconds = best_seconds(runs, [&] {
+                verified &= trees[run++]->verify();
+            });
+
+            const auto nodes = trees.front()->get_tree().size();
+
+            std::cout << "    " << std::setw(8) << std::left << (std::to_string(functions) + (unique ? "u" : ""))
+                << std::setw(10) << std::right << std::fixed << std::setprecision(1) << seconds * 1e9 / nodes << " ns/node"
+                << "  (" << nodes << " nodes, " << std::setprecision(2) << seconds * 1e3 << " ms"
+                << (verified ? "" : ", FAILED") << ")" << std::endl;
+        }
+    }
+
+    void bench_codegen(const uint32_t functions, const uint32_t terms, const uint32_t runs) {
+        const auto source = generate_expressions(functions, terms);
+        const auto file = neonc::source_manager().add("<bench>", source);
+        const auto tokens = neonc::Lexer(1).Tokenize(file);
+        auto ast = neonc::Parser().parse_ast(tokens);
+        auto target = neonc::Target();
+
+        ast.verify();
+
+        std::cout << "codegen: " << functions << " expressions of " << terms << " terms, best of " << runs << std::endl;
+
+        // a fresh module each run, lowering the same tree again must not see the previous functions
+        const double seconds = best_seconds(runs, [&] {
+            auto module = target.create_module("bench");
+
+            ast.build(module);
+            ast.finalize(module);
+        });
+
+        std::cout << "    " << std::setw(8) << std::left << "expr"
+            << std::setw(10) << std::right << std::fixed << std::setprecision(1) << double(functions) * terms / seconds / 1e6 << " M terms/s"
+            << "  (" << std::setprecision(1) << seconds * 1e3 << " ms)" << std::endl;
+    }
+
+    // optimization and object emission of a module large enough to be split, a fresh module every run
+    // since compiling consumes it, the archive has to come out the same for every thread count
+    void bench_backend(const uint32_t functions, const uint32_t terms, const neonc::OptLevel level, const uint32_t runs) {
+        const auto source = generate_expressions(functions, terms);
+        const auto file = neonc::source_manager().add("<bench>", source);
+        const auto tokens = neonc::Lexer(1).Tokenize(file);
+        auto ast = neonc::Parser().parse_ast(tokens);
+        auto target = neonc::Target(level);
+        const auto out = (std::filesystem::temp_directory_path() / "neon-bench-backend").string();
+
+        ast.verify();
+
+        auto lower = [&] {
+            auto module = target.create_module("bench");
+
+            ast.build(module);
+            ast.finalize(module);
+
+            return module;
+        };
+
+        auto read = [&] {
+            std::ifstream stream(out + ".a", std::ios::binary);
+
+            return std::string(std::istreambuf_iterator<char>(stream), {});
+        };
+
+        std::cout << "backend: " << functions << " expressions of " << terms << " terms, "
+            << target.partition_count(lower()) << " partitions, best of " << runs << std::endl;
+
+        double scalar = 0;
+        std::string expected;
+
+        const uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+
+        for (uint32_t threads : { 1u, 2u, 4u, hardware }) {
+            double best = std::numeric_limits<double>::max();
+
+            for (uint32_t i = 0; i < runs; i++) {
+                auto module = lower();
+
+                const auto start = std::chrono::steady_clock::now();
+                target.compile(module, out, threads);
+                const auto end = std::chrono::steady_clock::now();
+
+                best = std::min(best, std::chrono::duration<double>(end - start).count());
+            }
+
+            if (expected.empty()) {
+                scalar = best;
+                expected = read();
+            }
+
+            std::cout << "    " << std::setw(8) << std::left << (std::to_string(threads) + "t")
+                << std::setw(10) << std::right << std::fixed << std::setprecision(1) << best * 1e3 << " ms"
+                << "  x" << std::setprecision(2) << scalar / best
+                << "  (" << (!expected.empty() && read() == expected ? "identical" : "MISMATCH") << ")" << std::endl;
+        }
+
+        std::filesystem::remove(out + ".a");
+    }
+}
+
+auto main(int argc, char * argv[]) -> int {
+    const std::string what = argc > 1 ? argv[1] : "all";
+    bool passed = true;
+
+    if (what == "lexer" || what == "all")
+        bench_lexer(32, 5);
+
+    if (what == "relex" || what == "all")
+        passed &= bench_relex(2000);
+
+    if (what == "tokens" || what == "all")
+        passed &= bench_tokens(100, 1000);
+
+    if (what == "parser" || what == "all")
+        bench_parser(100, 10000, 5);
+
+    if (what == "analyzer" || what == "all")
+        bench_analyzer(20, 5);
+
+    if (what == "codegen" || what == "all")
+        bench_codegen(100, 10000, 5);
+
+    if (what == "backend" || what == "all")
+        bench_backend(100, 2000, neonc::OptLevel::O2, 3);
+
+    return passed ? 0 : 1;
+}
@@ -1,7 +1,52 @@
 #include <neonc/compiler.h>
+#include <iostream>
+#include <string>
+#include <vector>
 
 auto main(int argc, char * argv[]) -> int {
-    neonc::build(argv[1]);
+    auto options = neonc::BuildOptions();
+    const char * entry = nullptr;
+    bool run = false;
+    std::vector<std::string> arguments;
 
-    return 0;
+    for (int i = 1; i < argc; i++) {
+        const auto arg = std::string_view(argv[i]);
+
+        // everything after the file of `run` belongs to the program
+        if (run && entry != nullptr) {
+            arguments.emplace_back(arg);
+        } else if (arg == "run" && !run && entry == nullptr) {
+            run = true;
+        } else if (const auto level = neonc::parse_opt_level(arg); level) {
+            options.opt_level = *level;
+        } else if (arg == "-o" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg.starts_with("-j") && arg.size() > 2 && arg.substr(2).find_first_not_of("0123456789") == std::string_view::npos) {
+            options.threads = std::stoul(std::string(arg.substr(2)));
+        } else if (arg.starts_with("-")) {
+            std::cerr << "unknown option '" << arg << "'" << std::endl;
+
+            return 1;
+        } else {
+            entry = argv[i];
+        }
+    }
+
+    if (entry == nullptr) {
+        std::cerr << "usage: neon [-O0|-O1|-O2|-O3|-Os|-Oz] [-j<threads>] [-o <executable>] <file>" << std::endl;
+        std::cerr << "       neon [-O0|-O1|-O2|-O3|-Os|-Oz] [-j<threads>] run <file> [arguments...]" << std::endl;
+
+        return 1;
+    }
+
+    if (run && !options.output.empty()) {
+        std::cerr << "'-o' cannot be used with run" << std::endl;
+
+        return 1;
+    }
+
+    if (run)
+        return neonc::run(entry, arguments, options).value_or(1);
+
+    return neonc::build(entry, options) ? 0 : 1;
 }
@@ -1,23 +1,22 @@
 #include "analyzer.h"
 
 namespace neonc {
-    void Analyzer::throw_error(const std::optional<Position> position, const char * message) {
-        _throw_error(absolute_file_path, position, message);
+    void Analyzer::throw_error(const SourceLoc location, const char * message) {
+        _throw_error(location, message);
 
         success = false;
     }
 
-    bool Analyzer::analyze(std::shared_ptr<Node> _root) {
-        if (auto root = std::dynamic_pointer_cast<Root>(_root); root) {
-            for (auto & node : root->nodes) {
-                if (auto func = std::dynamic_pointer_cast<Function>(node); func) {
-                    scope.push();
+    bool Analyzer::analyze(const FlatTree & tree) {
+        if (tree.tag(FlatTree::ROOT) == NodeId::Root) {
+            // functions may be called before they are defined
+            functions = FunctionTable(tree);
 
-                    analyze_function(root, func);
-    
-                    scope.pop();
+            for (auto node : tree.children(FlatTree::ROOT)) {
+                if (tree.tag(node) == NodeId::Function) {
+                    analyze_function(tree, node);
                 } else {
-                    throw_error(node->position, "unexpected");
+                    throw_error(tree.location(node), "unexpected");
                 }
             }
         } else {
@@ -31,78 +30,106 @@ namespace neonc {
 
     //
 
-    void Analyzer::analyze_function(std::shared_ptr<Root> root, std::shared_ptr<Function> func) {
-        for (auto node : func->nodes) {
-            if (auto var = std::dynamic_pointer_cast<Variable>(node); var) {
-                scope.add_to_scope(var);
+    void Analyzer::analyze_function(const FlatTree & tree, const NodeIndex func) {
+        auto function = tree.get<Function>(func);
 
-                analyze_variable_type_inference(root, var);
-                analyze_variable_type_checking(root, var);
+        locals.clear();
+        slots.clear();
+
+        for (auto node : tree.children(func)) {
+            resolve(tree, node, function);
+
+            if (tree.tag(node) == NodeId::Variable) {
+                auto var = tree.get<Variable>(node);
+
+                analyze_variable_type_inference(tree, node, var, function);
+                analyze_variable_type_checking(tree, node, var);
+
+                // in scope only after its initializer, `var x = x + 1` reads the previous `x`
+                if (var->get_declare()) {
+                    var->slot = locals.size();
+                    slots[var->identifier] = var->slot;
+
+                    locals.push_back(var);
+                }
             }
         }
     }
 
-    void Analyzer::analyze_variable_type_inference(std::shared_ptr<Root> root, std::shared_ptr<Variable> var) {
-        if (!var->type) {
-            if (auto _call = query_first(var, NodeId::Call); _call) {
-                auto funcs = query(root, NodeId::Function);
-
-                bool found = false;
-
-                for (auto fn : funcs) {
-                    if (auto func = std::dynamic_pointer_cast<Function>(fn); func) {
-                        if (auto call = std::dynamic_pointer_cast<Call>(_call.value()); call) { 
-                            if (func->identifier == call->identifier) {
-                                if (auto ret_type = func->get_return_type(); ret_type) {
-                                    var->type = ret_type.value();
-                                } else {
-                                    var->type = Type(std::nullopt, _call->get()->position);
-                                }
-
-                                found = true;
-
-                                break;
-                            }
-                        } else {
-                            goto _err;
-                        }
-                    } else {
-                    _err:
-                        std::cerr << "ICE: cannot cast node to function or call" << std::endl;
-                        exit(0);
-                    }
+    void Analyzer::resolve(const FlatTree & tree, const NodeIndex statement, const Function * func) {
+        for (NodeIndex i = statement; i < tree.end(statement); i++) {
+            if (tree.tag(i) == NodeId::Identifier) {
+                auto ident = tree.get<Identifier>(i);
+
+                if (slots.contains(ident->identifier)) {
+                    ident->binding = { Binding::Kind::LOCAL, slots[ident->identifier] };
+
+                    continue;
+                }
+
+                const auto arguments = func->get_arguments();
+                const auto argument = std::find_if(arguments.begin(), arguments.end(), [&](const Argument & arg) {
+                    return !arg.get_variadic() && arg.get_identifier() == ident->identifier;
+                });
+
+                if (argument != arguments.end()) {
+                    ident->binding = { Binding::Kind::ARGUMENT, static_cast<uint32_t>(argument - arguments.begin()) };
+                } else {
+                    throw_error(ident->location, "undefined variable");
                 }
+            } else if (tree.tag(i) == NodeId::Call) {
+                auto call = tree.get<Call>(i);
 
-                if (!found) {
-                    throw_error(std::dynamic_pointer_cast<Call>(_call.value())->position, "undefined function");
+                if (auto position = functions.find(call->identifier); position) {
+                    call->function = *position;
+                } else {
+                    throw_error(call->location, "undefined function");
                 }
-            } else if (auto _ident = query_first(var, NodeId::Identifier); _ident) {
-                if (auto ident = std::dynamic_pointer_cast<Identifier>(_ident.value()); ident) {
-                    if (auto result = scope.find_variable(ident->identifier); result) {
-                        var->type = result->get()->type;
-                    } else {
-                        throw_error(ident->position, "undefined variable");
-                    }
+            }
+        }
+    }
+
+    // unresolved names are already reported by resolve()
+    void Analyzer::analyze_variable_type_inference(const FlatTree & tree, const NodeIndex index, Variable * var, const Function * func) {
+        if (!var->type) {
+            const auto first = query_firsts(tree, index);
+
+            auto first_of = [&](const NodeId id) {
+                return first[static_cast<uint8_t>(id)];
+            };
+
+            if (auto _call = first_of(NodeId::Call); _call) {
+                auto call = tree.get<Call>(_call.value());
+
+                if (call->function == Call::UNRESOLVED)
+                    return;
+
+                auto callee = functions.get(call->function);
+
+                if (auto ret_type = callee->get_return_type(); ret_type) {
+                    var->type = ret_type.value();
                 } else {
-                    std::cerr << "ICE: cannot cast node to identifier" << std::endl;
-                    exit(0);
+                    var->type = Type(std::nullopt, call->location);
+                }
+            } else if (auto _ident = first_of(NodeId::Identifier); _ident) {
+                auto binding = tree.get<Identifier>(_ident.value())->binding;
+
+                if (binding.kind == Binding::Kind::LOCAL) {
+                    var->type = locals[binding.index]->type;
+                } else if (binding.kind == Binding::Kind::ARGUMENT) {
+                    var->type = func->get_arguments()[binding.index].get_type();
                 }
-            } else if (auto _string = query_first(var, NodeId::String); _string) {
-                var->type = Type("str", _string->get()->position);
-            } else if (auto _boolean = query_first(var, NodeId::Boolean); _boolean) {
-                var->type = Type("bool", _boolean->get()->position);
-            } else if (auto _num = query_first(var, NodeId::Number); _num) {
-                if (auto num = std::dynamic_pointer_cast<Number>(_num.value()); num) {
-                    if (num->is_floating_point) {
-                        // TODO: size checking
-                        var->type = Type("f32", _num->get()->position);
-                    } else {
-                        // TODO: size checking
-                        var->type = Type("i32", _num->get()->position);
-                    }
+            } else if (auto _string = first_of(NodeId::String); _string) {
+                var->type = Type(symbol::STR, tree.location(_string.value()));
+            } else if (auto _boolean = first_of(NodeId::Boolean); _boolean) {
+                var->type = Type(symbol::BOOL, tree.location(_boolean.value()));
+            } else if (auto _num = first_of(NodeId::Number); _num) {
+                if (tree.get<Number>(_num.value())->is_floating_point) {
+                    // TODO: size checking
+                    var->type = Type(symbol::F32, tree.location(_num.value()));
                 } else {
-                    std::cerr << "ICE: cannot cast node to number" << std::endl;
-                    exit(0);
+                    // TODO: size checking
+                    var->type = Type(symbol::I32, tree.location(_num.value()));
                 }
             } else {
                 std::cerr << "ICE: cannot type inference" << std::endl;
@@ -111,7 +138,7 @@ namespace neonc {
         }
     }
 
-    void Analyzer::analyze_variable_type_checking(std::shared_ptr<Root> root, std::shared_ptr<Variable> var) {
+    void Analyzer::analyze_variable_type_checking(const FlatTree & tree, const NodeIndex index, Variable * var) {
         const auto & type = var->type;
 
         if (!var->nodes.empty()) {
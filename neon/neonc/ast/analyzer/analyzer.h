@@ -3,31 +3,37 @@
 #include <neonc.h>
 #include "err.h"
 #include "query.h"
-#include "scope.h"
+#include "functions.h"
 #include "../type.h"
 #include "../node.h"
+#include "../flat.h"
 #include "../root.h"
 #include "../function.h"
 #include "../variable.h"
+#include "../identifier.h"
+#include "../call.h"
 
 namespace neonc {
     class Analyzer {
     public:
-        Analyzer(const std::string absolute_file_path): absolute_file_path(absolute_file_path) {}
-
-        bool analyze(std::shared_ptr<Node> root);
+        bool analyze(const FlatTree & tree);
     private:
-        const std::string absolute_file_path;
-
         bool success = true;
 
-        Scope scope;
-  
-        void throw_error(const std::optional<Position> position, const char * message);
+        FunctionTable functions;
+
+        // of the function being analyzed, its variables by slot and the slot each name refers to so far
+        std::vector<Variable *> locals;
+        SymbolMap<uint32_t> slots;
+
+        void throw_error(const SourceLoc location, const char * message);
+
+        void analyze_function(const FlatTree & tree, const NodeIndex func);
 
-        void analyze_function(std::shared_ptr<Root> root, std::shared_ptr<Function> func);
+        // binds every identifier and call in the subtree of `statement`, codegen only follows the bindings
+        void resolve(const FlatTree & tree, const NodeIndex statement, const Function * func);
 
-        void analyze_variable_type_inference(std::shared_ptr<Root> root, std::shared_ptr<Variable> var);
-        void analyze_variable_type_checking(std::shared_ptr<Root> root, std::shared_ptr<Variable> var);
+        void analyze_variable_type_inference(const FlatTree & tree, const NodeIndex index, Variable * var, const Function * func);
+        void analyze_variable_type_checking(const FlatTree & tree, const NodeIndex index, Variable * var);
     };
 }
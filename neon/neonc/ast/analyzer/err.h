@@ -1,10 +1,11 @@
 #pragma once
 
 #include <neonc.h>
-#include "../../types/position.h"
+#include "../../types/source_loc.h"
 #include "../../util/clicolor.h"
-#include "../../util/extract_from_file.h"
+#include "../../source/source_manager.h"
+#include "../../source/diagnostics.h"
 
 namespace neonc {
-    void _throw_error(const std::string absolute_file_path, const std::optional<Position> position, const char * message);
+    void _throw_error(const SourceLoc location, const char * message);
 }
@@ -0,0 +1,22 @@
+#include "functions.h"
+
+namespace neonc {
+    FunctionTable::FunctionTable(const FlatTree & tree): tree(&tree) {
+        const auto items = tree.children(FlatTree::ROOT);
+
+        for (uint32_t i = 0; i < items.size(); i++)
+            if (tree.tag(items[i]) == NodeId::Function)
+                positions[tree.get<Function>(items[i])->identifier] = i;
+    }
+
+    std::optional<uint32_t> FunctionTable::find(const Symbol identifier) const {
+        if (auto position = positions.find(identifier); position)
+            return *position;
+
+        return std::nullopt;
+    }
+
+    const Function * FunctionTable::get(const uint32_t position) const {
+        return tree->get<Function>(tree->children(FlatTree::ROOT)[position]);
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <neonc.h>
+#include "../flat.h"
+#include "../function.h"
+
+namespace neonc {
+    // top level functions of a tree by name, built once before anything is analyzed, so resolving a
+    // call is a bounds check and an index instead of a walk over the tree
+    class FunctionTable {
+    public:
+        FunctionTable() = default;
+        explicit FunctionTable(const FlatTree & tree);
+
+        // position of the function among the items of the root, the same position codegen uses
+        std::optional<uint32_t> find(const Symbol identifier) const;
+
+        const Function * get(const uint32_t position) const;
+    private:
+        const FlatTree * tree = nullptr;
+
+        SymbolMap<uint32_t> positions;
+    };
+}
@@ -1,30 +1,25 @@
 #include "query.h"
 
 namespace neonc {
-    std::optional<std::shared_ptr<Node>> query_first(std::shared_ptr<Node> node, NodeId id) {
-        if (node->id() == id)
-            return node;
-
-        for (auto n : node->nodes)
-            if (auto result = query_first(n, id); result)
-                return result;
+    std::optional<NodeIndex> query_first(const FlatTree & tree, NodeIndex node, NodeId id) {
+        for (NodeIndex i = node; i < tree.end(node); i++)
+            if (tree.tag(i) == id)
+                return i;
 
         return std::nullopt;
     }
 
-    std::vector<std::shared_ptr<Node>> query(std::shared_ptr<Node> node, NodeId id) {
-        std::vector<std::shared_ptr<Node>> nodes = {};
-
-        if (node->id() == id)
-            nodes.push_back(node);
+    Query query(const FlatTree & tree, NodeIndex node, NodeId id) {
+        return Query(tree, node, id);
+    }
 
-        for (auto n : node->nodes) {
-            auto result = query(n, id);
+    FirstNodes query_firsts(const FlatTree & tree, NodeIndex node) {
+        FirstNodes first;
 
-            if (!result.empty())
-                nodes.insert(nodes.end(), result.begin(), result.end());
-        }
+        // backwards, so that earlier nodes overwrite later ones of the same tag
+        for (NodeIndex i = tree.end(node); i-- > node;)
+            first[static_cast<uint8_t>(tree.tag(i))] = i;
 
-        return nodes;
+        return first;
     }
 }
@@ -2,8 +2,66 @@
 
 #include <neonc.h>
 #include "../node.h"
+#include "../flat.h"
 
 namespace neonc {
-    std::optional<std::shared_ptr<Node>> query_first(std::shared_ptr<Node> node, NodeId id);
-    std::vector<std::shared_ptr<Node>> query(std::shared_ptr<Node> node, NodeId id);
+    // nodes tagged `id` in the subtree of a node including itself in pre-order, found while iterating,
+    // nothing is collected up front
+    class Query {
+    public:
+        class Iterator {
+        public:
+            Iterator(const FlatTree & tree, const NodeIndex index, const NodeIndex end, const NodeId id): tree(&tree), index(index), end(end), id(id) {
+                skip();
+            }
+
+            NodeIndex operator*() const {
+                return index;
+            }
+
+            Iterator & operator++() {
+                index++;
+                skip();
+
+                return *this;
+            }
+
+            bool operator==(const Iterator & other) const {
+                return index == other.index;
+            }
+        private:
+            const FlatTree * tree;
+            NodeIndex index;
+            NodeIndex end;
+            NodeId id;
+
+            void skip() {
+                while (index < end && tree->tag(index) != id)
+                    index++;
+            }
+        };
+
+        Query(const FlatTree & tree, const NodeIndex node, const NodeId id): tree(tree), node(node), id(id) {}
+
+        Iterator begin() const {
+            return Iterator(tree, node, tree.end(node), id);
+        }
+
+        Iterator end() const {
+            return Iterator(tree, tree.end(node), tree.end(node), id);
+        }
+    private:
+        const FlatTree & tree;
+        NodeIndex node;
+        NodeId id;
+    };
+
+    // first node of every tag in the subtree of `node` including itself, indexed by NodeId
+    using FirstNodes = std::array<std::optional<NodeIndex>, NODE_ID_COUNT>;
+
+    std::optional<NodeIndex> query_first(const FlatTree & tree, NodeIndex node, NodeId id);
+    Query query(const FlatTree & tree, NodeIndex node, NodeId id);
+
+    // a single scan for when several tags are asked for
+    FirstNodes query_firsts(const FlatTree & tree, NodeIndex node);
 }
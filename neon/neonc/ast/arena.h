@@ -0,0 +1,87 @@
+#pragma once
+
+#include <neonc.h>
+
+namespace neonc {
+    // bump allocator owning every node of one ast, nodes are never destroyed one by one, the whole
+    // tree goes away with the arena, so everything allocated here has to be trivially destructible
+    class AstArena {
+    public:
+        AstArena() = default;
+
+        AstArena(const AstArena &) = delete;
+        AstArena & operator=(const AstArena &) = delete;
+
+        template<typename T, typename ... Args>
+        T * make(Args && ... args) {
+            static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+
+            return new (allocator.Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        template<typename T>
+        T * allocate(const std::size_t count) {
+            static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+
+            return static_cast<T *>(allocator.Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        std::string_view copy(const std::string_view text) {
+            auto data = allocate<char>(text.size());
+            std::memcpy(data, text.data(), text.size());
+
+            return std::string_view(data, text.size());
+        }
+
+        template<typename T>
+        llvm::MutableArrayRef<T> copy(llvm::ArrayRef<T> items) {
+            auto data = allocate<T>(items.size());
+            std::uninitialized_copy(items.begin(), items.end(), data);
+
+            return llvm::MutableArrayRef<T>(data, items.size());
+        }
+
+        std::size_t bytes() const {
+            return allocator.getBytesAllocated();
+        }
+    private:
+        llvm::BumpPtrAllocator allocator;
+    };
+
+    // growable array in an arena, doubling leaves the old storage behind until the arena is released,
+    // which costs at most as much again as the final size
+    template<typename T>
+    class ArenaVector {
+    public:
+        T * begin() const { return data; }
+        T * end() const { return data + count; }
+
+        uint32_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        T & operator[](const uint32_t index) const { return data[index]; }
+        T & back() const { return data[count - 1]; }
+
+        void push_back(AstArena & arena, T item) {
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 2;
+
+                auto grown = arena.allocate<T>(capacity);
+                std::uninitialized_copy(data, data + count, grown);
+
+                data = grown;
+            }
+
+            new (data + count++) T(item);
+        }
+
+        void pop_back() {
+            count--;
+        }
+    private:
+        T * data = nullptr;
+
+        uint32_t count = 0;
+        uint32_t capacity = 0;
+    };
+}
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <neonc.h>
-#include "../types/position.h"
+#include "../types/source_loc.h"
 #include "../util/clicolor.h"
 #include "node.h"
 #include "type.h"
@@ -9,16 +9,14 @@
 namespace neonc {
     struct Argument : public Node {
         Argument(
-            const std::string identifier,
+            const Symbol identifier,
             const std::optional<Type> type,
-            const std::optional<Position> position
-        ): identifier(identifier), type(type), Node(position) {}
+            const SourceLoc location
+        ): identifier(identifier), type(type), Node(ID, location) {}
        
-        virtual NodeId id() const {
-            return NodeId::Argument;
-        }
+        static constexpr NodeId ID = NodeId::Argument;
 
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             (void)indentation;
 
             std::cout << identifier << ": ";
@@ -38,11 +36,11 @@ namespace neonc {
             return type;
         }
 
-        const std::optional<Position> & get_position() const {
-            return position;
+        SourceLoc get_location() const {
+            return location;
         }
 
-        const std::string get_identifier() const {
+        Symbol get_identifier() const {
             return identifier;
         }
 
@@ -58,7 +56,7 @@ namespace neonc {
             is_variadic = _is_variadic;
         }
     private:
-        std::string identifier;
+        Symbol identifier;
         std::optional<Type> type = std::nullopt;
 
         bool is_variadic = false;
@@ -3,21 +3,35 @@
 #include "analyzer/analyzer.h"
 
 namespace neonc {
-    std::shared_ptr<Node> AbstractSyntaxTree::get_root_ptr() {
+    Node * AbstractSyntaxTree::get_root_ptr() {
         return root;
     }
 
+    AstArena & AbstractSyntaxTree::get_arena() {
+        return *arenas.front();
+    }
+
+    const FlatTree & AbstractSyntaxTree::get_tree() {
+        if (!tree)
+            tree.emplace(root);
+
+        return *tree;
+    }
+
     void AbstractSyntaxTree::dump() const {
-        root->dump(0);
+        dump_node(root, 0);
     }
 
-    void AbstractSyntaxTree::verify() {
-        auto analyzer = Analyzer(absolute_file_path);
+    bool AbstractSyntaxTree::verify() {
+        auto analyzer = Analyzer();
 
-        if (!analyzer.analyze(get_root_ptr()))
-            exit(0);
+        verified = analyzer.analyze(get_tree());
+
+        return verified;
+    }
 
-        verified = true;
+    bool AbstractSyntaxTree::is_verified() const {
+        return verified;
     }
 
     void AbstractSyntaxTree::build(Module & module) {
@@ -26,7 +40,7 @@ namespace neonc {
             exit(0);
         }
 
-        root->build(module);
+        build_node(root, module);
 
         built = true;
     }
@@ -37,6 +51,6 @@ namespace neonc {
             exit(0);
         }
         
-        root->finalize(module);
+        finalize_node(root, module);
     }
 }
@@ -2,26 +2,34 @@
 
 #include "node.h"
 #include "root.h"
+#include "flat.h"
 
 namespace neonc {
     class AbstractSyntaxTree {
     public:
+        // `root` has to be allocated in the first of `arenas`, the tree takes ownership of all nodes in them,
+        // a tree that is known to be analyzed already, like one loaded from the AstCache, is passed as `verified`
         AbstractSyntaxTree(
-            std::shared_ptr<Node> root,
-            const std::string absolute_file_path
-        ): root(root), absolute_file_path(absolute_file_path) {}
+            std::vector<std::unique_ptr<AstArena>> arenas,
+            Node * root,
+            const bool verified = false
+        ): verified(verified), arenas(std::move(arenas)), root(root) {}
 
-        std::shared_ptr<Node> get_root_ptr();
+        Node * get_root_ptr();
+        AstArena & get_arena();
+        const FlatTree & get_tree();
         void dump() const;
-        void verify();
+        // errors go to diagnostics(), only a verified tree can be built
+        bool verify();
+        bool is_verified() const;
         void build(Module & module);
         void finalize(Module & module);
     private:
-        const std::string absolute_file_path;
-
         bool verified = false;
         bool built = false;
 
-        std::shared_ptr<Node> root;
+        std::vector<std::unique_ptr<AstArena>> arenas;
+        Node * root;
+        std::optional<FlatTree> tree; // flattened on first use, parsing alone does not pay for it
     };
 }
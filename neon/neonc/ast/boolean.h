@@ -5,13 +5,11 @@
 
 namespace neonc {
     struct Boolean : public Node {
-        Boolean(bool value, std::optional<Position> position): value(value), Node(position) {}
+        Boolean(bool value, SourceLoc location): value(value), Node(ID, location) {}
 
-        virtual NodeId id() const {
-            return NodeId::Boolean;
-        }
+        static constexpr NodeId ID = NodeId::Boolean;
 
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             (void)indentation;
 
             std::cout << (value ? "true" : "false");
@@ -0,0 +1,609 @@
+#include "cache.h"
+#include "visitor.h"
+
+namespace neonc {
+    namespace {
+        constexpr uint32_t MAGIC = 0x5453414e; // "NAST"
+
+        // stands in for a missing name or location
+        constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t key;
+            uint64_t checksum; // of everything after the header
+
+            uint32_t words;
+            uint32_t nodes;
+            uint32_t arguments;
+            uint32_t names;
+            uint32_t bytes;
+            uint32_t reserved;
+        };
+
+        // `data` per tag:
+        //   Root        path offset, path length
+        //   Function    identifier, return type, return type location, first argument, argument count
+        //   Variable    identifier, type, type location, slot
+        //   Operator    operator
+        //   Call        identifier, callee
+        //   Identifier  identifier, binding kind, binding index
+        //   Number      bit width, first word, spelling offset, spelling length
+        //   String      offset, length
+        struct NodeRecord {
+            NodeId tag;
+            uint8_t flags;
+            uint16_t reserved;
+            uint32_t location;
+            uint32_t children;
+            uint32_t data[5];
+        };
+
+        struct ArgumentRecord {
+            uint32_t identifier;
+            uint32_t type;
+            uint32_t type_location;
+            uint32_t location;
+            uint32_t flags;
+        };
+
+        struct NameRecord {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        static_assert(sizeof(Header) == 48 && sizeof(NodeRecord) == 32 && sizeof(ArgumentRecord) == 20);
+
+        // NodeRecord::flags and ArgumentRecord::flags
+        namespace flag {
+            constexpr uint8_t PUBLIC = 1 << 0; // function
+            constexpr uint8_t DECLARATION = 1 << 1; // function
+            constexpr uint8_t DECLARE = 1 << 2; // variable
+            constexpr uint8_t HAS_TYPE = 1 << 3; // function return type, variable and argument type
+            constexpr uint8_t VALUE = 1 << 4; // boolean
+            constexpr uint8_t NEGATIVE = 1 << 5; // number
+            constexpr uint8_t FLOATING_POINT = 1 << 6; // number
+            constexpr uint8_t VARIADIC = 1 << 7; // argument
+        }
+
+        class Writer {
+        public:
+            std::vector<uint64_t> words;
+            std::vector<NodeRecord> nodes;
+            std::vector<ArgumentRecord> arguments;
+            std::vector<NameRecord> names;
+            std::string bytes;
+
+            uint32_t location(const SourceLoc location) const {
+                return location.valid() ? source_manager().offset(location) : NONE;
+            }
+
+            uint32_t name(const Symbol symbol) {
+                if (!symbol.valid())
+                    return NONE;
+
+                if (!indices.contains(symbol)) {
+                    indices[symbol] = names.size();
+                    names.push_back({ text(symbol.name()), static_cast<uint32_t>(symbol.name().size()) });
+                }
+
+                return indices[symbol];
+            }
+
+            uint32_t text(const std::string_view text) {
+                const uint32_t offset = bytes.size();
+                bytes.append(text);
+
+                return offset;
+            }
+
+            // name and location of an optional type, sets HAS_TYPE in `flags` if there is one
+            std::pair<uint32_t, uint32_t> type(const std::optional<Type> & type, uint8_t & flags) {
+                if (!type)
+                    return { NONE, NONE };
+
+                flags |= flag::HAS_TYPE;
+
+                return { type->get_data() ? name(*type->get_data()) : NONE, location(type->location) };
+            }
+
+            // false if the node cannot be stored, the tree is then not cached at all
+            bool add(const Node * node, const uint32_t children) {
+                NodeRecord record {};
+
+                record.tag = node->id();
+                record.location = location(node->location);
+                record.children = children;
+
+                switch (node->id()) {
+                case NodeId::Root: {
+                    auto root = node_cast<Root>(node);
+
+                    record.data[0] = text(root->file_path);
+                    record.data[1] = root->file_path.size();
+                } break;
+                case NodeId::Function: {
+                    auto function = node_cast<Function>(node);
+
+                    record.flags |= function->get_public() ? flag::PUBLIC : 0;
+                    record.flags |= function->get_is_declaration() ? flag::DECLARATION : 0;
+
+                    record.data[0] = name(function->identifier);
+                    std::tie(record.data[1], record.data[2]) = type(function->get_return_type(), record.flags);
+                    record.data[3] = arguments.size();
+                    record.data[4] = function->arguments_size();
+
+                    for (auto & argument : function->get_arguments()) {
+                        uint8_t flags = argument.get_variadic() ? flag::VARIADIC : 0;
+                        const auto [type_name, type_location] = type(argument.get_type(), flags);
+
+                        arguments.push_back({
+                            name(argument.get_identifier()),
+                            type_name,
+                            type_location,
+                            location(argument.get_location()),
+                            flags,
+                        });
+                    }
+                } break;
+                case NodeId::Variable: {
+                    auto variable = node_cast<Variable>(node);
+
+                    record.flags |= variable->get_declare() ? flag::DECLARE : 0;
+
+                    record.data[0] = name(variable->identifier);
+                    std::tie(record.data[1], record.data[2]) = type(variable->type, record.flags);
+                    record.data[3] = variable->slot;
+                } break;
+                case NodeId::Operator:
+                    record.data[0] = static_cast<uint32_t>(node_cast<Operator>(node)->op);
+                    break;
+                case NodeId::Boolean:
+                    record.flags |= node_cast<Boolean>(node)->value ? flag::VALUE : 0;
+                    break;
+                case NodeId::Call: {
+                    auto call = node_cast<Call>(node);
+
+                    record.data[0] = name(call->identifier);
+                    record.data[1] = call->function;
+                } break;
+                case NodeId::Identifier: {
+                    auto identifier = node_cast<Identifier>(node);
+
+                    record.data[0] = name(identifier->identifier);
+                    record.data[1] = static_cast<uint32_t>(identifier->binding.kind);
+                    record.data[2] = identifier->binding.index;
+                } break;
+                case NodeId::Number: {
+                    auto number = node_cast<Number>(node);
+                    const auto value = number->integer();
+
+                    record.flags |= number->negative ? flag::NEGATIVE : 0;
+                    record.flags |= number->is_floating_point ? flag::FLOATING_POINT : 0;
+
+                    record.data[0] = value.getBitWidth();
+                    record.data[1] = words.size();
+                    record.data[2] = text(number->spelling);
+                    record.data[3] = number->spelling.size();
+
+                    words.insert(words.end(), value.getRawData(), value.getRawData() + value.getNumWords());
+                } break;
+                case NodeId::String: {
+                    auto string = node_cast<String>(node);
+
+                    record.data[0] = text(string->string);
+                    record.data[1] = string->string.size();
+                } break;
+                case NodeId::Expression:
+                case NodeId::Return:
+                    break;
+                default:
+                    return false;
+                }
+
+                nodes.push_back(record);
+
+                return true;
+            }
+        private:
+            SymbolMap<uint32_t> indices;
+        };
+
+        class Reader {
+        public:
+            Reader(const Header & header, const char * body, const FileId file): header(header), file(file) {
+                words = reinterpret_cast<const uint64_t *>(body);
+                nodes = reinterpret_cast<const NodeRecord *>(words + header.words);
+                arguments = reinterpret_cast<const ArgumentRecord *>(nodes + header.nodes);
+                names = reinterpret_cast<const NameRecord *>(arguments + header.arguments);
+                bytes = reinterpret_cast<const char *>(names + header.names);
+            }
+
+            // nullptr if a record refers outside of its section, checked even though the checksum matched,
+            // a well formed file from a different build of the compiler must not crash this one
+            Node * read(AstArena & arena) {
+                symbols.reserve(header.names);
+
+                for (uint32_t i = 0; i < header.names; i++) {
+                    if (!in_bytes(names[i].offset, names[i].length))
+                        return nullptr;
+
+                    symbols.push_back(interner().intern(std::string_view(bytes + names[i].offset, names[i].length)));
+                }
+
+                struct Frame {
+                    Node * node;
+                    uint32_t remaining;
+                };
+
+                std::vector<Frame> stack;
+                Node * root = nullptr;
+
+                for (uint32_t i = 0; i < header.nodes; i++) {
+                    const auto & record = nodes[i];
+
+                    // the root is the first node and nothing follows its subtree
+                    if ((i == 0) != (record.tag == NodeId::Root) || (i > 0 && stack.empty()))
+                        return nullptr;
+
+                    auto node = make(arena, record, i == 0 ? nullptr : stack.back().node);
+
+                    if (node == nullptr)
+                        return nullptr;
+
+                    if (i == 0)
+                        root = node;
+                    else {
+                        stack.back().node->add_node(arena, node);
+                        stack.back().remaining--;
+                    }
+
+                    if (record.children > 0)
+                        stack.push_back({ node, record.children });
+
+                    while (!stack.empty() && stack.back().remaining == 0)
+                        stack.pop_back();
+                }
+
+                if (!stack.empty())
+                    return nullptr;
+
+                // calls may refer to functions further down, so they are checked once every item is known
+                for (auto call : calls)
+                    if (call->function != Call::UNRESOLVED && (call->function >= root->nodes.size() || !node_cast<Function>(root->nodes[call->function])))
+                        return nullptr;
+
+                return root;
+            }
+        private:
+            const Header & header;
+            const FileId file;
+
+            const uint64_t * words;
+            const NodeRecord * nodes;
+            const ArgumentRecord * arguments;
+            const NameRecord * names;
+            const char * bytes;
+
+            std::vector<Symbol> symbols;
+
+            // of the item being read, codegen indexes the arguments and variables of a function with
+            // these without checking, a variable is visible from the statement after its declaration on
+            struct Scope {
+                uint32_t arguments = 0;
+                uint32_t slots = 0;
+                uint32_t visible = 0;
+            } scope;
+
+            std::vector<Call *> calls;
+
+            bool in_bytes(const uint32_t offset, const uint32_t length) const {
+                return offset <= header.bytes && length <= header.bytes - offset;
+            }
+
+            std::optional<std::string_view> text(AstArena & arena, const uint32_t offset, const uint32_t length) const {
+                if (!in_bytes(offset, length))
+                    return std::nullopt;
+
+                return arena.copy(std::string_view(bytes + offset, length));
+            }
+
+            std::optional<Symbol> name(const uint32_t index) const {
+                if (index == NONE)
+                    return Symbol {};
+
+                if (index >= symbols.size())
+                    return std::nullopt;
+
+                return symbols[index];
+            }
+
+            SourceLoc location(const uint32_t offset) const {
+                return offset == NONE ? SourceLoc() : source_manager().location(file, offset);
+            }
+
+            // outer nullopt if the type is malformed
+            std::optional<std::optional<Type>> type(const uint8_t flags, const uint32_t index, const uint32_t type_location) const {
+                if (!(flags & flag::HAS_TYPE))
+                    return std::optional<Type>();
+
+                const auto data = name(index);
+
+                if (!data)
+                    return std::nullopt;
+
+                return std::optional<Type>(Type(data->valid() ? std::optional<Symbol>(*data) : std::nullopt, location(type_location)));
+            }
+
+            Node * make(AstArena & arena, const NodeRecord & record, const Node * parent) {
+                const auto at = location(record.location);
+                const auto & data = record.data;
+
+                if (parent != nullptr && parent->id() == NodeId::Root) {
+                    scope = {};
+                } else if (parent != nullptr && parent->id() == NodeId::Function) {
+                    scope.visible = scope.slots;
+                }
+
+                switch (record.tag) {
+                case NodeId::Root: {
+                    const auto path = text(arena, data[0], data[1]);
+
+                    return path ? arena.make<Root>(arena, std::string(*path)) : nullptr;
+                }
+                case NodeId::Function: {
+                    const auto identifier = name(data[0]);
+                    const auto return_type = type(record.flags, data[1], data[2]);
+
+                    if (!identifier || !return_type || data[3] > header.arguments || data[4] > header.arguments - data[3])
+                        return nullptr;
+
+                    std::vector<Argument> _arguments;
+
+                    for (uint32_t i = data[3]; i < data[3] + data[4]; i++) {
+                        const auto & argument = arguments[i];
+                        const auto argument_identifier = name(argument.identifier);
+                        const auto argument_type = type(argument.flags, argument.type, argument.type_location);
+
+                        if (!argument_identifier || !argument_type)
+                            return nullptr;
+
+                        _arguments.emplace_back(*argument_identifier, *argument_type, location(argument.location));
+                        _arguments.back().set_variadic(argument.flags & flag::VARIADIC);
+                    }
+
+                    auto function = arena.make<Function>(*identifier, at);
+
+                    function->set_public(record.flags & flag::PUBLIC);
+                    function->set_is_declaration(record.flags & flag::DECLARATION);
+                    function->set_return_type(*return_type);
+                    function->set_arguments(arena, _arguments);
+
+                    scope.arguments = data[4];
+
+                    return function;
+                }
+                case NodeId::Variable: {
+                    const auto identifier = name(data[0]);
+                    const auto variable_type = type(record.flags, data[1], data[2]);
+
+                    if (!identifier || !variable_type)
+                        return nullptr;
+
+                    if (record.flags & flag::DECLARE) {
+                        // slots are handed out in order of declaration
+                        if (data[3] > scope.slots)
+                            return nullptr;
+
+                        scope.slots = std::max(scope.slots, data[3] + 1);
+
+                        auto variable = arena.make<Variable>(*identifier, *variable_type, at);
+                        variable->slot = data[3];
+
+                        return variable;
+                    }
+
+                    auto variable = arena.make<Variable>();
+                    variable->type = *variable_type;
+
+                    return variable;
+                }
+                case NodeId::Expression:
+                    return arena.make<Expression>();
+                case NodeId::Return:
+                    return arena.make<Return>(at);
+                case NodeId::Operator:
+                    if (data[0] > static_cast<uint32_t>(op::Operator::B_RIGHT_SHIFT))
+                        return nullptr;
+
+                    return arena.make<Operator>(static_cast<op::Operator>(data[0]));
+                case NodeId::Boolean:
+                    return arena.make<Boolean>(record.flags & flag::VALUE, at);
+                case NodeId::Call: {
+                    const auto identifier = name(data[0]);
+
+                    if (!identifier)
+                        return nullptr;
+
+                    auto call = arena.make<Call>(*identifier, at);
+                    call->function = data[1];
+
+                    calls.push_back(call);
+
+                    return call;
+                }
+                case NodeId::Identifier: {
+                    const auto identifier = name(data[0]);
+
+                    if (!identifier || data[1] > static_cast<uint32_t>(Binding::Kind::ARGUMENT))
+                        return nullptr;
+
+                    const auto kind = static_cast<Binding::Kind>(data[1]);
+
+                    if ((kind == Binding::Kind::LOCAL && data[2] >= scope.visible) || (kind == Binding::Kind::ARGUMENT && data[2] >= scope.arguments))
+                        return nullptr;
+
+                    auto node = arena.make<Identifier>(*identifier, at);
+                    node->binding = { kind, data[2] };
+
+                    return node;
+                }
+                case NodeId::Number: {
+                    const auto count = llvm::APInt::getNumWords(data[0]);
+                    const auto spelling = text(arena, data[2], data[3]);
+
+                    if (data[0] == 0 || data[1] > header.words || count > header.words - data[1] || !spelling)
+                        return nullptr;
+
+                    const auto bits = llvm::APInt(data[0], llvm::ArrayRef<uint64_t>(words + data[1], count));
+
+                    if (record.flags & flag::FLOATING_POINT) {
+                        if (data[0] != 64)
+                            return nullptr;
+
+                        return arena.make<Number>(arena, llvm::APFloat(llvm::APFloat::IEEEdouble(), bits), *spelling, record.flags & flag::NEGATIVE, at);
+                    }
+
+                    return arena.make<Number>(arena, bits, *spelling, record.flags & flag::NEGATIVE, at);
+                }
+                case NodeId::String: {
+                    const auto string = text(arena, data[0], data[1]);
+
+                    return string ? arena.make<String>(*string, at) : nullptr;
+                }
+                default:
+                    return nullptr;
+                }
+            }
+        };
+    }
+
+    uint64_t AstCache::key(const FileId file) const {
+        const auto contents = source_manager().buffer(file);
+        const auto hash = llvm::xxHash64(llvm::StringRef(contents.data(), contents.size()));
+
+        // the root node holds the path of the file, so two copies of a file do not share an entry
+        auto identity = std::string(NEONC_VERSION) + '\0'
+            + std::to_string(FORMAT_VERSION) + '\0'
+            + source_manager().path(file) + '\0'
+            + std::to_string(hash);
+
+        return llvm::xxHash64(identity);
+    }
+
+    std::string AstCache::entry(const uint64_t key) const {
+        return directory + "/" + llvm::utohexstr(key, true) + ".ast";
+    }
+
+    std::optional<AbstractSyntaxTree> AstCache::load(const FileId file) const {
+        const auto expected = key(file);
+
+        // a single read only mapping, aligned so that the sections can be used in place
+        auto buffer = llvm::MemoryBuffer::getFile(entry(expected), false, false, false, llvm::Align(alignof(Header)));
+
+        if (!buffer || (*buffer)->getBufferSize() < sizeof(Header))
+            return std::nullopt;
+
+        const auto data = (*buffer)->getBufferStart();
+        const auto & header = *reinterpret_cast<const Header *>(data);
+
+        if (header.magic != MAGIC || header.version != FORMAT_VERSION || header.key != expected)
+            return std::nullopt;
+
+        const uint64_t size = sizeof(Header)
+            + uint64_t(header.words) * sizeof(uint64_t)
+            + uint64_t(header.nodes) * sizeof(NodeRecord)
+            + uint64_t(header.arguments) * sizeof(ArgumentRecord)
+            + uint64_t(header.names) * sizeof(NameRecord)
+            + header.bytes;
+
+        if (size != (*buffer)->getBufferSize())
+            return std::nullopt;
+
+        const auto body = llvm::ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(data) + sizeof(Header), size - sizeof(Header));
+
+        // a torn or corrupted entry is a miss, the file is parsed and the entry rewritten
+        if (llvm::xxHash64(body) != header.checksum)
+            return std::nullopt;
+
+        std::vector<std::unique_ptr<AstArena>> arenas;
+        arenas.push_back(std::make_unique<AstArena>());
+
+        auto root = Reader(header, data + sizeof(Header), file).read(*arenas.front());
+
+        if (root == nullptr)
+            return std::nullopt;
+
+        return AbstractSyntaxTree(std::move(arenas), root, true);
+    }
+
+    void AstCache::store(const FileId file, AbstractSyntaxTree & ast) const {
+        if (!ast.is_verified())
+            return;
+
+        auto writer = Writer();
+        auto & tree = ast.get_tree();
+
+        for (NodeIndex i = 0; i < tree.size(); i++)
+            if (!writer.add(tree.node(i), tree.children(i).size()))
+                return;
+
+        auto header = Header {
+            MAGIC,
+            FORMAT_VERSION,
+            key(file),
+            0,
+            static_cast<uint32_t>(writer.words.size()),
+            static_cast<uint32_t>(writer.nodes.size()),
+            static_cast<uint32_t>(writer.arguments.size()),
+            static_cast<uint32_t>(writer.names.size()),
+            static_cast<uint32_t>(writer.bytes.size()),
+            0,
+        };
+
+        std::string body;
+
+        auto append = [&](const auto & items) {
+            body.append(reinterpret_cast<const char *>(items.data()), items.size() * sizeof(items[0]));
+        };
+
+        append(writer.words);
+        append(writer.nodes);
+        append(writer.arguments);
+        append(writer.names);
+        body.append(writer.bytes);
+
+        header.checksum = llvm::xxHash64(body);
+
+        if (llvm::sys::fs::create_directories(directory))
+            return;
+
+        // written next to the entry and renamed over it, a concurrent build never maps half a file
+        const auto path = entry(header.key);
+
+        int fd = -1;
+        llvm::SmallString<128> temporary;
+
+        if (llvm::sys::fs::createUniqueFile(path + ".%%%%%%.tmp", fd, temporary))
+            return;
+
+        {
+            auto out = llvm::raw_fd_ostream(fd, true);
+
+            out.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+            out.write(body.data(), body.size());
+            out.close();
+
+            if (out.has_error()) {
+                out.clear_error();
+                llvm::sys::fs::remove(temporary);
+
+                return;
+            }
+        }
+
+        if (llvm::sys::fs::rename(temporary, path))
+            llvm::sys::fs::remove(temporary);
+    }
+}
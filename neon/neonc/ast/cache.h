@@ -0,0 +1,40 @@
+#pragma once
+
+#include <neonc.h>
+#include "ast.h"
+#include "../source/source_manager.h"
+
+namespace neonc {
+    // verified asts on disk, one file per source file named by a hash of its contents, its path and the
+    // compiler version, so an entry is never stale, only unused, a hit skips lexing, parsing and analysis
+    //
+    // the format has no pointers, every section is an array of fixed size little endian records and
+    // everything refers to everything else by index, so the file is used straight from its mapping:
+    //
+    //   Header
+    //   uint64_t words[]             raw words of number literals
+    //   NodeRecord nodes[]           pre-order, each followed by its `children` subtrees
+    //   ArgumentRecord arguments[]   arguments of all functions, in order
+    //   NameRecord names[]           interned names, re-interned on load
+    //   char bytes[]                 names, strings, number spellings and the root path
+    //
+    // locations are stored as offsets into the file, they depend on the order in which files are loaded
+    class AstCache {
+    public:
+        explicit AstCache(const std::string & directory): directory(directory) {}
+
+        // bumped whenever the layout of a record or of a node changes
+        static constexpr uint32_t FORMAT_VERSION = 2;
+
+        // the tree of `file` if an entry exists and is intact, anything else is a miss
+        std::optional<AbstractSyntaxTree> load(const FileId file) const;
+
+        // writes a verified tree of `file`, failing to write is not an error, the next build parses again
+        void store(const FileId file, AbstractSyntaxTree & ast) const;
+    private:
+        std::string directory;
+
+        uint64_t key(const FileId file) const;
+        std::string entry(const uint64_t key) const;
+    };
+}
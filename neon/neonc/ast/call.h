@@ -6,17 +6,15 @@
 
 namespace neonc {
     struct Call : public Node {
-        Call(const std::string identifier, const std::optional<Position> position): identifier(identifier), Node(position) {}
+        Call(const Symbol identifier, const SourceLoc location): identifier(identifier), Node(ID, location) {}
 
-        virtual NodeId id() const {
-            return NodeId::Call;
-        }
+        static constexpr NodeId ID = NodeId::Call;
 
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             std::cout << identifier << ColorYellow << "(" << ColorReset;
 
             for (uint32_t i = 0; i < nodes.size(); i++) {
-                nodes[i]->dump(indentation);
+                dump_node(nodes[i], indentation);
 
                 if (i < nodes.size() - 1)
                     std::cout << ", ";
@@ -26,9 +24,12 @@ namespace neonc {
         }
 
         llvm::Value * build(Module & module, std::vector<llvm::Value *> args) {
-            return module.get_builder()->CreateCall(module.module->getFunction(identifier), args);
+            return module.get_builder()->CreateCall(module.get_function(function), args);
         }
 
-        std::string identifier;
+        static constexpr uint32_t UNRESOLVED = std::numeric_limits<uint32_t>::max();
+
+        Symbol identifier;
+        uint32_t function = UNRESOLVED; // position of the callee among the items of the root, filled in by the analyzer
     };
 }
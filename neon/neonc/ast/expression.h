@@ -11,17 +11,15 @@
 
 namespace neonc {
     struct Expression : public Node {
-        Expression(): Node(std::nullopt) {}
+        Expression(): Node(ID, SourceLoc()) {}
 
-        virtual NodeId id() const {
-            return NodeId::Expression;
-        }
+        static constexpr NodeId ID = NodeId::Expression;
 
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             std::cout << ColorGreen << BoldFont << "( " << ColorReset;
 
             for (auto & n : nodes)
-                n->dump(indentation);
+                dump_node(n, indentation);
 
             std::cout << ColorGreen << BoldFont << " )" << ColorReset;
         }
@@ -33,17 +31,11 @@ namespace neonc {
             }
 
             llvm::Value * value = nullptr;
-            std::optional<std::shared_ptr<Operator>> op = std::nullopt;
+            Operator * op = nullptr;
 
+            // { operand }, { lhs, op, rhs } or { op, operand } for prefix operators
             for (auto & n : nodes) {
-                if (auto expr = std::dynamic_pointer_cast<Expression>(n); expr) {
-                    auto _value = expr->build(module, type);
-                    value = op.has_value() ? op->get()->build(module, value, _value, type) : _value;
-
-                    continue;
-                }
-
-                if (auto _op = std::dynamic_pointer_cast<Operator>(n); _op) {
+                if (auto _op = node_cast<Operator>(n); _op) {
                     if (type == llvm::Type::getVoidTy(*module.context)) {
                         std::cerr << "ICE: operation on void type" << std::endl;
                         exit(0);
@@ -54,71 +46,92 @@ namespace neonc {
                     continue;
                 }
 
-                if (auto num = std::dynamic_pointer_cast<Number>(n); num) {
-                    auto _value = num->build(module, type);
-                    value = op.has_value() ? op->get()->build(module, value, _value, type) : _value;
-                    
-                    continue;
-                }
-
-                if (auto boolean = std::dynamic_pointer_cast<Boolean>(n); boolean) {
-                    auto _value = (llvm::Value *)boolean->build(module);
-                    value = op.has_value() ? op->get()->build(module, value, _value, type) : _value;
+                auto _value = build_operand(module, n, type);
 
-                    continue;
+                if (op == nullptr) {
+                    value = _value;
+                } else if (value == nullptr) {
+                    value = op->build_unary(module, _value, type);
+                } else {
+                    value = op->build(module, value, _value, type);
                 }
+            }
 
-                if (auto identifier = std::dynamic_pointer_cast<Identifier>(n); identifier) {
-                    if (module.local_variables.contains(identifier->identifier)) {
-                        auto _value = module.get_builder()->CreateLoad(type, module.local_variables[identifier->identifier]);
-                        value = op.has_value() ? op->get()->build(module, value, _value, type) : _value;
-                    } else if (module.get_arguments().contains(identifier->identifier)) {
-                        auto _value = module.get_arguments()[identifier->identifier];
-                        value = op.has_value() ? op->get()->build(module, value, _value, type) : _value;
-                    } else {
-                        throw std::invalid_argument("ICE: unknown identifier");
-                    }
-
-                    continue;
-                }
+            return value;
+        }
+    private:
+        // a variable read where a different width of the same kind is expected, like an i32 passed as i64
+        llvm::Value * convert(Module & module, llvm::Value * value, llvm::Type * type) {
+            if (value->getType() == type)
+                return value;
 
-                if (auto call = std::dynamic_pointer_cast<Call>(n); call) {
-                    std::vector<llvm::Value *> args;
+            // bools widen to 0 or 1, sign extending would make true -1
+            if (value->getType()->isIntegerTy(1) && type->isIntegerTy())
+                return module.get_builder()->CreateZExtOrTrunc(value, type);
 
-                    for (uint32_t i = 0; i < call->nodes.size(); i++) {
-                        if (auto expr = std::dynamic_pointer_cast<Expression>(call->nodes[i]); expr) {
-                            llvm::Type * _t = nullptr;
+            if (value->getType()->isIntegerTy() && type->isIntegerTy())
+                return module.get_builder()->CreateSExtOrTrunc(value, type);
 
-                            if (i < module.module->getFunction(call->identifier)->arg_size()) {
-                                _t = module.module->getFunction(call->identifier)->getArg(i)->getType();
-                            } else {
-                                // TODO: get actual type of vaarg
-                                _t = llvm::Type::getInt32Ty(*module.context);
-                            }
+            if (value->getType()->isFloatingPointTy() && type->isFloatingPointTy())
+                return module.get_builder()->CreateFPCast(value, type);
 
-                            if (_t == nullptr) {
-                                std::cerr << "ICE: call arg type is nullptr" << std::endl;
-                                exit(0);
-                            }
+            return value;
+        }
 
-                            args.push_back(expr->build(module, _t));
+        llvm::Value * build_operand(Module & module, Node * n, llvm::Type * type) {
+            switch (n->id()) {
+            case NodeId::Expression:
+                return static_cast<Expression *>(n)->build(module, type);
+            case NodeId::Number:
+                return static_cast<Number *>(n)->build(module, type);
+            case NodeId::Boolean:
+                return (llvm::Value *)static_cast<Boolean *>(n)->build(module);
+            case NodeId::String:
+                return (llvm::Value *)static_cast<String *>(n)->build(module);
+            case NodeId::Identifier: {
+                auto binding = static_cast<Identifier *>(n)->binding;
+
+                if (binding.kind == Binding::Kind::LOCAL)
+                    return convert(module, module.local_variables[binding.index], type);
+
+                if (binding.kind == Binding::Kind::ARGUMENT)
+                    return module.get_argument(binding.index);
+
+                throw std::invalid_argument("ICE: unresolved identifier");
+            }
+            case NodeId::Call: {
+                auto call = static_cast<Call *>(n);
+                auto callee = module.get_function(call->function);
+                std::vector<llvm::Value *> args;
+
+                for (uint32_t i = 0; i < call->nodes.size(); i++) {
+                    if (auto expr = node_cast<Expression>(call->nodes[i]); expr) {
+                        llvm::Type * _t = nullptr;
+
+                        if (i < callee->arg_size()) {
+                            _t = callee->getArg(i)->getType();
+                        } else {
+                            // TODO: get actual type of vaarg
+                            _t = llvm::Type::getInt32Ty(*module.context);
                         }
-                    }
 
-                    auto _value = (llvm::Value *)call->build(module, args);
-                    value = op.has_value() ? op->get()->build(module, value, _value, type) : _value;
+                        if (_t == nullptr) {
+                            std::cerr << "ICE: call arg type is nullptr" << std::endl;
+                            exit(0);
+                        }
 
-                    continue;
+                        args.push_back(expr->build(module, _t));
+                    }
                 }
 
-                if (auto string = std::dynamic_pointer_cast<String>(n); string) {
-                    value = (llvm::Value *)string->build(module);
-
-                    continue;
-                }
+                return (llvm::Value *)call->build(module, args);
+            }
+            default:
+                break;
             }
 
-            return value;
+            std::cerr << "ICE: unknown node in expression" << std::endl;
+            exit(0);
         }
     };
 }
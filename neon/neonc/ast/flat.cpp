@@ -0,0 +1,49 @@
+#include "flat.h"
+
+namespace neonc {
+    FlatTree::FlatTree(Node * root) {
+        struct Frame {
+            Node * node;
+            NodeIndex index;
+            uint32_t child;
+        };
+
+        std::vector<Frame> stack;
+
+        // numbers `node` and reserves its children in `extra`, pre-order numbering makes the reserved
+        // ranges follow each other in index order, so `first_child` needs no separate counts
+        auto visit = [&](Node * node) {
+            const NodeIndex index = tags.size();
+
+            tags.push_back(node->id());
+            locations.push_back(node->location);
+            ends.push_back(index + 1);
+            first_child.push_back(extra.size());
+            payload.push_back(node);
+
+            extra.resize(extra.size() + node->nodes.size());
+            stack.push_back({ node, index, 0 });
+        };
+
+        // no recursion, expressions may nest thousands of levels deep
+        visit(root);
+
+        while (!stack.empty()) {
+            auto & frame = stack.back();
+
+            if (frame.child == frame.node->nodes.size()) {
+                ends[frame.index] = tags.size();
+                stack.pop_back();
+
+                continue;
+            }
+
+            auto child = frame.node->nodes[frame.child];
+            extra[first_child[frame.index] + frame.child++] = tags.size();
+
+            visit(child);
+        }
+
+        first_child.push_back(extra.size());
+    }
+}
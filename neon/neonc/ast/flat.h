@@ -0,0 +1,59 @@
+#pragma once
+
+#include <neonc.h>
+#include "node.h"
+
+namespace neonc {
+    // index of a node in a FlatTree, nodes are numbered in pre-order, so the descendants of a node
+    // are exactly the indices in (index, end(index))
+    using NodeIndex = uint32_t;
+
+    // data oriented view of a parsed ast, one entry per node in parallel arrays and the children of
+    // every node in a single extra array, walking a subtree is a linear scan over `tags` instead of
+    // chasing child pointers through the arena
+    class FlatTree {
+    public:
+        explicit FlatTree(Node * root);
+
+        static constexpr NodeIndex ROOT = 0;
+
+        uint32_t size() const {
+            return tags.size();
+        }
+
+        NodeId tag(const NodeIndex index) const {
+            return tags[index];
+        }
+
+        SourceLoc location(const NodeIndex index) const {
+            return locations[index];
+        }
+
+        // one past the last descendant of `index`
+        NodeIndex end(const NodeIndex index) const {
+            return ends[index];
+        }
+
+        llvm::ArrayRef<NodeIndex> children(const NodeIndex index) const {
+            return llvm::ArrayRef<NodeIndex>(extra.data() + first_child[index], extra.data() + first_child[index + 1]);
+        }
+
+        Node * node(const NodeIndex index) const {
+            return payload[index];
+        }
+
+        // payload of a node whose kind is already known from its tag
+        template<typename T>
+        T * get(const NodeIndex index) const {
+            return static_cast<T *>(payload[index]);
+        }
+    private:
+        std::vector<NodeId> tags;
+        std::vector<SourceLoc> locations;
+        std::vector<NodeIndex> ends;
+        std::vector<uint32_t> first_child; // into `extra`, has one more entry than there are nodes
+        std::vector<Node *> payload;
+
+        std::vector<NodeIndex> extra;
+    };
+}
@@ -8,15 +8,13 @@
 namespace neonc {
     struct Function : public Node {
         Function(
-            const std::string identifier,
-            const std::optional<Position> position
-        ): identifier(identifier), Node(position) {}
+            const Symbol identifier,
+            const SourceLoc location
+        ): identifier(identifier), Node(ID, location) {}
 
-        virtual NodeId id() const {
-            return NodeId::Function;
-        }
+        static constexpr NodeId ID = NodeId::Function;
 
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             std::cout << cli::indent(indentation)
                 << cli::colorize((is_public ? "pub " : ""), indentation)
                 << cli::colorize("fn ", indentation)
@@ -46,7 +44,7 @@ namespace neonc {
             std::cout << "{\n";
 
             for (auto & node : nodes)
-                node->dump(indentation + 1);
+                dump_node(node, indentation + 1);
 
             std::cout << cli::indent(indentation) << "}";
 
@@ -69,7 +67,7 @@ namespace neonc {
             }
 
             auto func_type = llvm::FunctionType::get(
-                identifier == "main" && !return_type ? llvm::Type::getInt32Ty(*module.context) :
+                identifier == symbol::MAIN && !return_type ? llvm::Type::getInt32Ty(*module.context) :
                 return_type ? (llvm::Type *)return_type->build(module) : llvm::Type::getVoidTy(*module.context),
                 args,
                 is_variadic
@@ -77,19 +75,29 @@ namespace neonc {
 
             auto func = llvm::Function::Create(
                 func_type,
-                identifier == "main" ? llvm::Function::ExternalLinkage :
+                identifier == symbol::MAIN ? llvm::Function::ExternalLinkage :
                 is_public ? llvm::Function::ExternalLinkage : llvm::Function::PrivateLinkage,
-                identifier,
+                identifier.name(),
                 *module.module
             );
 
-            func->addFnAttr(llvm::Attribute::NoInline);
-            func->addFnAttr(llvm::Attribute::OptimizeNone);
             func->addFnAttr(llvm::Attribute::NoUnwind);
-            func->addFnAttr("frame-pointer", "all");
             func->addFnAttr("min-legal-vector-width", "0");
             func->addFnAttr("no-trapping-math", "true");
-            func->addFnAttr("stack-protector-buffer-size", "8");
+
+            // debug builds keep every function as written, with frame pointers and stack protectors
+            if (module.opt_level == OptLevel::O0) {
+                func->addFnAttr(llvm::Attribute::NoInline);
+                func->addFnAttr(llvm::Attribute::OptimizeNone);
+                func->addFnAttr("frame-pointer", "all");
+                func->addFnAttr("stack-protector-buffer-size", "8");
+            }
+
+            if (module.opt_level == OptLevel::Os || module.opt_level == OptLevel::Oz)
+                func->addFnAttr(llvm::Attribute::OptimizeForSize);
+
+            if (module.opt_level == OptLevel::Oz)
+                func->addFnAttr(llvm::Attribute::MinSize);
             if (!module.target_cpu.empty())
                 func->addFnAttr("target-cpu", module.target_cpu);
             if (!module.target_features.empty())
@@ -98,40 +106,36 @@ namespace neonc {
 
             //
 
-            if (!is_declaration) {
+            // the root points the module at the position of this function before building it
+            if (is_declaration) {
+                module.functions[module.pointer] = { func, nullptr };
+            } else {
                 llvm::BasicBlock::Create(*module.context, "", func);
                 std::shared_ptr<llvm::IRBuilder<>> builder(new llvm::IRBuilder<>(&func->getEntryBlock(), func->getEntryBlock().begin()));
-          
-                std::map<std::string, llvm::Value *> _arguments;
-                for (uint32_t i = 0; i < arguments.size(); i++) {
-                    _arguments[arguments[i].get_identifier()] = func->getArg(i);
-                }
 
-                module.pointer = identifier;
-                module.functions[identifier] = {{func, _arguments}, builder};
+                module.functions[module.pointer] = { func, builder };
             }
 
             return nullptr;
         }
 
         void finalize(Module & module) {
-            if (identifier == "main" && !return_type) {
-                module.get_builder(identifier)->CreateRet(module.get_builder(identifier)->getInt32(0));
+            if (is_declaration)
+                return;
+
+            if (identifier == symbol::MAIN && !return_type) {
+                module.get_builder()->CreateRet(module.get_builder()->getInt32(0));
 
                 return;
             }
 
             if (!return_type) {
-                module.get_builder(identifier)->CreateRetVoid();
+                module.get_builder()->CreateRetVoid();
             }
         }
 
-        void add_argument(Argument argument) {
-            arguments.push_back(argument);
-        }
-
-        void add_arguments(std::vector<Argument> _args) {
-            arguments.insert(arguments.end(), _args.begin(), _args.end());
+        void set_arguments(AstArena & arena, const std::vector<Argument> & _args) {
+            arguments = arena.copy(llvm::ArrayRef<Argument>(_args));
         }
 
         void set_return_type(std::optional<Type> _return_type) {
@@ -154,15 +158,23 @@ namespace neonc {
             return is_public;
         }
 
+        bool get_is_declaration() const {
+            return is_declaration;
+        }
+
+        llvm::ArrayRef<Argument> get_arguments() const {
+            return arguments;
+        }
+
         uint32_t arguments_size() const {
             return arguments.size();
         }
 
-        const std::string identifier;
+        const Symbol identifier;
     private:
         std::optional<Type> return_type = std::nullopt;
 
-        std::vector<Argument> arguments;
+        llvm::MutableArrayRef<Argument> arguments;
 
         bool is_public = false;
         bool is_declaration = false;
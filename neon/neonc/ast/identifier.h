@@ -4,19 +4,30 @@
 #include <neonc.h>
 
 namespace neonc {
+    // what an identifier refers to, filled in by the analyzer
+    struct Binding {
+        enum class Kind : uint8_t {
+            UNRESOLVED,
+            LOCAL, // `index` is the slot of a variable of the enclosing function
+            ARGUMENT, // `index` is the position of an argument of the enclosing function
+        };
+
+        Kind kind = Kind::UNRESOLVED;
+        uint32_t index = 0;
+    };
+
     struct Identifier : public Node {
-        Identifier(const std::string identifier, const std::optional<Position> position): identifier(identifier), Node(position) {}
+        Identifier(const Symbol identifier, const SourceLoc location): identifier(identifier), Node(ID, location) {}
 
-        virtual NodeId id() const {
-            return NodeId::Identifier;
-        }
+        static constexpr NodeId ID = NodeId::Identifier;
 
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             (void)indentation;
 
             std::cout << identifier;
         }
 
-        std::string identifier;
+        Symbol identifier;
+        Binding binding;
     };
 }
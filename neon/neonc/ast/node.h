@@ -1,14 +1,16 @@
 #pragma once
 
-#include "../types/position.h"
+#include "../types/source_loc.h"
+#include "../types/symbol.h"
 #include <neonc.h>
 #include "../util/clicolor.h"
 #include "../llvm/module.h"
+#include "arena.h"
 
 #define DEF_INDENT_MUL 4
 
 namespace neonc {
-    enum class NodeId {
+    enum class NodeId : uint8_t {
         None,
 
         Root,
@@ -29,40 +31,58 @@ namespace neonc {
         Return,
     };
 
-    struct Node {
-        Node(const std::optional<Position> position): position(position) {}
-        virtual ~Node() = default;
-
-        virtual NodeId id() const = 0;
+    constexpr std::size_t NODE_ID_COUNT = static_cast<std::size_t>(NodeId::Return) + 1;
 
-        virtual void dump(const uint32_t indentation) const = 0;
+    struct Node;
 
-        virtual void * build(Module & module) {
-            (void)module;
+    using NodeList = ArenaVector<Node *>;
 
-            return nullptr;
-        }
+    // nodes live in an AstArena and are released with it, there is deliberately no virtual destructor,
+    // nor any other virtual function, every node class declares its tag as `ID` and code dispatching
+    // on the kind of a node switches on id(), see visitor.h
+    struct Node {
+        Node(const NodeId kind, const SourceLoc location): location(location), kind(kind) {}
 
-        virtual void finalize(Module & module) {
-            (void)module;
+        NodeId id() const {
+            return kind;
         }
 
         template<typename T, typename ... Args>
-        std::shared_ptr<T> add_node(Args ... args) {
-            nodes.push_back(std::make_shared<T>(args...));
-            
-            return std::dynamic_pointer_cast<T>(nodes.back());
+        T * add_node(AstArena & arena, Args && ... args) {
+            auto node = arena.make<T>(std::forward<Args>(args)...);
+
+            nodes.push_back(arena, node);
+
+            return node;
         }
 
-        void add_node(std::shared_ptr<Node> node) {
-            nodes.push_back(node);
+        void add_node(AstArena & arena, Node * node) {
+            nodes.push_back(arena, node);
         }
 
-        std::vector<std::shared_ptr<Node>> nodes;
+        NodeList nodes;
 
-        std::optional<Position> position;
+        SourceLoc location;
+    private:
+        NodeId kind;
     };
 
+    // checked downcast, nullptr if `node` is of another kind
+    template<typename T>
+    T * node_cast(Node * node) {
+        return node->id() == T::ID ? static_cast<T *>(node) : nullptr;
+    }
+
+    template<typename T>
+    const T * node_cast(const Node * node) {
+        return node->id() == T::ID ? static_cast<const T *>(node) : nullptr;
+    }
+
+    // dispatch on the kind of `node`, defined next to the visitor where every node class is complete
+    void dump_node(const Node * node, const uint32_t indentation);
+    void build_node(Node * node, Module & module);
+    void finalize_node(Node * node, Module & module);
+
     namespace cli {
         constexpr const std::string colorize(const std::string input, const uint32_t indentation) {
             constexpr uint8_t len = 5;
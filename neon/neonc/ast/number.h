@@ -1,44 +1,122 @@
 #pragma once
 
 #include "node.h"
+#include "analyzer/err.h"
+#include "../lexer/token.h"
 #include <neonc.h>
 
 namespace neonc {
     struct Number : public Node {
         Number(
-            const std::string value,
-            const bool is_floating_point,
-            const std::optional<Position> position
-        ): value(value), is_floating_point(is_floating_point), Node(position) {}
+            AstArena & arena,
+            const NumberLiteral & value,
+            const std::string_view spelling,
+            const bool negative,
+            const SourceLoc location
+        ): spelling(spelling), negative(negative), is_floating_point(std::holds_alternative<llvm::APFloat>(value)), Node(ID, location) {
+            // the value is kept as raw words in the arena, APInt and APFloat themselves are not trivially destructible
+            const auto bits = is_floating_point ? std::get<llvm::APFloat>(value).bitcastToAPInt() : std::get<llvm::APInt>(value);
 
-        virtual NodeId id() const {
-            return NodeId::Number;    
+            width = bits.getBitWidth();
+            words = arena.copy(llvm::ArrayRef<uint64_t>(bits.getRawData(), bits.getNumWords()));
         }
 
-        virtual void dump(const uint32_t indentation) const {
+        static constexpr NodeId ID = NodeId::Number;
+
+        void dump(const uint32_t indentation) const {
             (void)indentation;
 
-            std::cout << value;
+            std::cout << (negative ? "-" : "") << spelling;
         }
 
         llvm::Value * build(Module & module, llvm::Type * type) {
-            if (type == llvm::Type::getInt8Ty(*module.context)) return module.get_builder()->getInt8(std::stoll(value));
-            if (type == llvm::Type::getInt16Ty(*module.context)) return module.get_builder()->getInt16(std::stoll(value));
-            if (type == llvm::Type::getInt32Ty(*module.context)) return module.get_builder()->getInt32(std::stoll(value));
-            if (type == llvm::Type::getInt64Ty(*module.context)) return module.get_builder()->getInt64(std::stoll(value));
-         
-            if (type == llvm::Type::getFloatTy(*module.context)) return llvm::ConstantFP::get(llvm::Type::getFloatTy(*module.context), std::stod(value));
-            if (type == llvm::Type::getDoubleTy(*module.context)) return llvm::ConstantFP::get(llvm::Type::getDoubleTy(*module.context), std::stod(value));
-
-            //
-
             if (type == nullptr)
                 throw std::invalid_argument("ICE: type in number.h is nullptr");
 
+            if (type->isIntegerTy(8) || type->isIntegerTy(16) || type->isIntegerTy(32) || type->isIntegerTy(64))
+                return llvm::ConstantInt::get(type, build_integer(module, type->getIntegerBitWidth()));
+
+            if (type->isFloatTy() || type->isDoubleTy())
+                return llvm::ConstantFP::get(*module.context, build_floating(module, type->getFltSemantics()));
+
             throw std::invalid_argument("ICE: unknown create_constat type in number.h");
         }
 
-        std::string value;
+        llvm::APInt integer() const {
+            return llvm::APInt(width, words);
+        }
+
+        llvm::APFloat floating() const {
+            return llvm::APFloat(llvm::APFloat::IEEEdouble(), integer());
+        }
+
+        std::string_view spelling; // points into the source buffer, which outlives the ast
+        bool negative;
         bool is_floating_point;
+    private:
+        uint32_t width;
+        llvm::ArrayRef<uint64_t> words;
+
+        // the literal is only range checked here, once the type it has to fit into is known
+        llvm::APInt build_integer(Module & module, const uint32_t bits) const {
+            if (is_floating_point) {
+                llvm::APSInt truncated(bits, false);
+                bool exact = false;
+
+                auto value = floating();
+
+                if (negative)
+                    value.changeSign();
+
+                if (value.convertToInteger(truncated, llvm::APFloat::rmTowardZero, &exact) & llvm::APFloat::opInvalidOp)
+                    out_of_range(module, bits);
+
+                return truncated;
+            }
+
+            const auto value = integer();
+
+            // magnitude has to fit below 2^(bits - 1), negative literals may reach it exactly
+            const auto limit = llvm::APInt::getOneBitSet(std::max(bits, value.getBitWidth()) + 1, bits - 1);
+            const auto magnitude = value.zext(limit.getBitWidth());
+
+            if (negative ? magnitude.ugt(limit) : magnitude.uge(limit))
+                out_of_range(module, bits);
+
+            auto result = value.zextOrTrunc(bits);
+
+            if (negative)
+                result.negate();
+
+            return result;
+        }
+
+        llvm::APFloat build_floating(Module & module, const llvm::fltSemantics & semantics) const {
+            llvm::APFloat result(semantics);
+            bool lost = false;
+
+            if (!is_floating_point) {
+                if (result.convertFromAPInt(integer(), false, llvm::APFloat::rmNearestTiesToEven) & llvm::APFloat::opOverflow)
+                    out_of_range(module, 0, &semantics);
+            } else {
+                result = floating();
+
+                if (result.convert(semantics, llvm::APFloat::rmNearestTiesToEven, &lost) & llvm::APFloat::opOverflow)
+                    out_of_range(module, 0, &semantics);
+            }
+
+            if (negative)
+                result.changeSign();
+
+            return result;
+        }
+
+        void out_of_range(Module & module, const uint32_t bits, const llvm::fltSemantics * semantics = nullptr) const {
+            auto message = semantics
+                ? std::string("number literal out of range for ") + (semantics == &llvm::APFloat::IEEEsingle() ? "f32" : "f64")
+                : "number literal out of range for i" + std::to_string(bits);
+
+            _throw_error(location, message.c_str());
+        }
     };
 }
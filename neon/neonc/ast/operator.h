@@ -29,13 +29,11 @@ namespace neonc {
     }
     
     struct Operator : public Node {
-        Operator(op::Operator op): op(op), Node(std::nullopt) {}
+        Operator(op::Operator op): op(op), Node(ID, SourceLoc()) {}
 
-        virtual NodeId id() const {
-            return NodeId::Operator;
-        }
+        static constexpr NodeId ID = NodeId::Operator;
         
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             (void)indentation;
 
             switch (op) {
@@ -187,15 +185,6 @@ namespace neonc {
                         }
                     }
                     break;
-                case op::Operator::NOT:
-                    {
-                        if (_type->isIntegerTy()) {
-                            value = module.get_builder()->CreateNot(_f);
-                        } else {
-                            throw std::invalid_argument("ICE: invalid type operation");
-                        }
-                    }
-                    break;
                 case op::Operator::AND:
                 case op::Operator::B_AND:
                     {
@@ -251,6 +240,26 @@ namespace neonc {
             return value;
         }
 
+        llvm::Value * build_unary(Module & module, llvm::Value * _f, llvm::Type * _type) {
+            switch (op) {
+            case op::Operator::MINUS:
+                if (_type->isIntegerTy())
+                    return module.get_builder()->CreateNeg(_f);
+
+                if (_type->isFloatTy() || _type->isDoubleTy())
+                    return module.get_builder()->CreateFNeg(_f);
+
+                throw std::invalid_argument("ICE: invalid type operation");
+            case op::Operator::NOT:
+                if (_type->isIntegerTy())
+                    return module.get_builder()->CreateNot(_f);
+
+                throw std::invalid_argument("ICE: invalid type operation");
+            default:
+                throw std::invalid_argument("ICE: unknown unary op");
+            }
+        }
+
         op::Operator op;
     };
 }
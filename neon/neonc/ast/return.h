@@ -6,24 +6,22 @@
 
 namespace neonc {
     struct Return : public Node {
-        Return(const std::optional<Position> position): Node(position) {}
+        Return(const SourceLoc location): Node(ID, location) {}
 
-        virtual NodeId id() const {
-            return NodeId::Return;
-        }
+        static constexpr NodeId ID = NodeId::Return;
         
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             std::cout << cli::indent(indentation) << cli::colorize("return ", indentation);
 
             for (auto & n : nodes)
-                n->dump(indentation);
+                dump_node(n, indentation);
 
             std::cout << std::endl;
         }
 
         void * build(Module & module) {
             if (!nodes.empty()) {
-                if (auto expr = std::dynamic_pointer_cast<Expression>(nodes.back()); expr) {
+                if (auto expr = node_cast<Expression>(nodes.back()); expr) {
                     auto value = expr->build(module, module.get_function()->getReturnType());
 
                     module.get_builder()->CreateRet(value);
@@ -19,33 +19,38 @@ namespace neonc {
     }
 
     struct Root : public Node {
-        Root(const std::string _file_path): Node(std::nullopt) {
-            file_path = replace_all(replace_all(_file_path, "/", "::"), "\\", "::");
+        Root(AstArena & arena, const std::string _file_path): Node(ID, SourceLoc()) {
+            file_path = arena.copy(replace_all(replace_all(_file_path, "/", "::"), "\\", "::"));
         }
 
-        virtual NodeId id() const {
-            return NodeId::Root;
-        }
+        static constexpr NodeId ID = NodeId::Root;
         
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             std::cout << cli::colorize("Root", indentation) << "<" << file_path << "> {" << "\n";
             
             for (auto & n : nodes)
-                n->dump(indentation + 1);
+                dump_node(n, indentation + 1);
 
             std::cout << "}" << std::endl;
         }
 
+        // functions are known to the module by their position in `nodes`, which is what calls resolve to
         void * build(Module & module) {
-            for (auto & n : nodes) // build top nodes
-                n->build(module);
-
-            for (auto & n : nodes) { // build insides
-                if (std::shared_ptr<Function> func = std::dynamic_pointer_cast<Function>(n); func) {
-                    module.pointer = func->identifier;
-                    
-                    for (auto & _n : n->nodes)
-                        _n->build(module);
+            module.functions.assign(nodes.size(), {});
+
+            for (uint32_t i = 0; i < nodes.size(); i++) { // build top nodes
+                module.pointer = i;
+
+                build_node(nodes[i], module);
+            }
+
+            for (uint32_t i = 0; i < nodes.size(); i++) { // build insides
+                if (node_cast<Function>(nodes[i])) {
+                    module.pointer = i;
+                    module.local_variables.clear();
+
+                    for (auto & _n : nodes[i]->nodes)
+                        build_node(_n, module);
                 }
             }
 
@@ -53,15 +58,16 @@ namespace neonc {
         }
 
         void finalize(Module & module) {
-            for (auto & n : nodes) {
-                n->finalize(module);
-                
-                if (!n->nodes.empty())
-                    for (auto & _n : n->nodes)
-                        _n->finalize(module);
+            for (uint32_t i = 0; i < nodes.size(); i++) {
+                module.pointer = i;
+
+                finalize_node(nodes[i], module);
+
+                for (auto & _n : nodes[i]->nodes)
+                    finalize_node(_n, module);
             }
         }
 
-        std::string file_path;
+        std::string_view file_path;
     };
 }
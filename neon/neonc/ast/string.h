@@ -5,7 +5,7 @@
 
 namespace neonc {
     namespace {
-        static const std::string escape_string(const std::string & input_string) {
+        static const std::string escape_string(const std::string_view input_string) {
             std::ostringstream escaped_string;
             for (char current_char : input_string) {
                 switch (current_char) {
@@ -35,22 +35,20 @@ namespace neonc {
     }
 
     struct String : public Node {
-        String(const std::string string, const std::optional<Position> position): string(string), Node(position) {}
+        String(const std::string_view string, const SourceLoc location): string(string), Node(ID, location) {}
 
-        virtual NodeId id() const {
-            return NodeId::String;
-        }
+        static constexpr NodeId ID = NodeId::String;
         
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             (void)indentation;
 
             std::cout << "\"" << escape_string(string) << "\"";
         }
 
         void * build(Module & module) {
-            return module.get_builder()->CreateGlobalString(string);
+            return module.get_builder()->CreateGlobalString(llvm::StringRef(string.data(), string.size()));
         }
 
-        std::string string;
+        std::string_view string; // copied into the arena, the token buffer may be gone by codegen
     };
 }
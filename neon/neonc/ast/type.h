@@ -7,13 +7,11 @@
 namespace neonc {
     class Type : public Node {
     public:
-        Type(std::optional<std::string> data, std::optional<Position> position): data(data), Node(position) {}
+        Type(std::optional<Symbol> data, SourceLoc location): data(data), Node(ID, location) {}
 
-        virtual NodeId id() const {
-            return NodeId::Type;
-        }
+        static constexpr NodeId ID = NodeId::Type;
 
-        virtual void dump(const uint32_t indentation) const {
+        void dump(const uint32_t indentation) const {
             (void)indentation;
 
             if (data) std::cout << data.value();
@@ -22,20 +20,20 @@ namespace neonc {
 
         void * build(Module & module) {
             // boolean type
-            if (data == "bool") return llvm::Type::getInt1Ty(*module.context);
+            if (data == symbol::BOOL) return llvm::Type::getInt1Ty(*module.context);
 
             // integer types
-            if (data == "i8") return llvm::Type::getInt8Ty(*module.context);
-            if (data == "i16") return llvm::Type::getInt16Ty(*module.context);
-            if (data == "i32") return llvm::Type::getInt32Ty(*module.context);
-            if (data == "i64") return llvm::Type::getInt64Ty(*module.context);
+            if (data == symbol::I8) return llvm::Type::getInt8Ty(*module.context);
+            if (data == symbol::I16) return llvm::Type::getInt16Ty(*module.context);
+            if (data == symbol::I32) return llvm::Type::getInt32Ty(*module.context);
+            if (data == symbol::I64) return llvm::Type::getInt64Ty(*module.context);
 
             // floating point types
-            if (data == "f32") return llvm::Type::getFloatTy(*module.context);
-            if (data == "f64") return llvm::Type::getDoubleTy(*module.context);
+            if (data == symbol::F32) return llvm::Type::getFloatTy(*module.context);
+            if (data == symbol::F64) return llvm::Type::getDoubleTy(*module.context);
 
             // str
-            if (data == "str") return module.dummy_builder->getPtrTy();
+            if (data == symbol::STR) return module.dummy_builder->getPtrTy();
 
             // void
             if (!data) return llvm::Type::getVoidTy(*module.context);
@@ -44,10 +42,10 @@ namespace neonc {
             exit(0);
         }
 
-        const std::optional<std::string> & get_data() const {
+        const std::optional<Symbol> & get_data() const {
             return data;
         }
     private:
-        std::optional<std::string> data = std::nullopt;
+        std::optional<Symbol> data = std::nullopt;
     };
 }
@@ -3,27 +3,24 @@
 #include "node.h"
 #include <neonc.h>
 #include "expression.h"
-#include "ast.h"
 #include "type.h"
 
 namespace neonc {
     struct Variable : public Node {
-        Variable(): Node(std::nullopt) {
+        Variable(): Node(ID, SourceLoc()) {
             declare = false;
         }
 
         Variable(
-            const std::string identifier,
+            const Symbol identifier,
             const std::optional<Type> type,
-            const std::optional<Position> position
-        ): identifier(identifier), type(type), Node(position) {}
+            const SourceLoc location
+        ): identifier(identifier), type(type), Node(ID, location) {}
        
-        virtual NodeId id() const {
-            return NodeId::Variable;
-        }
+        static constexpr NodeId ID = NodeId::Variable;
         
-        virtual void dump(const uint32_t indentation) const {
-            std::cout << cli::indent(indentation) << (declare ? cli::colorize("var ", indentation) : "_") << (declare ? identifier : "");
+        void dump(const uint32_t indentation) const {
+            std::cout << cli::indent(indentation) << (declare ? cli::colorize("var ", indentation) : "_") << (declare ? identifier.name() : "");
 
             std::cout << ": ";
             if (type) type->dump(indentation);
@@ -33,7 +30,7 @@ namespace neonc {
                 std::cout << " = ";
 
                 for (auto & n : nodes)
-                    n->dump(indentation);
+                    dump_node(n, indentation);
             }
 
             std::cout << std::endl;
@@ -43,38 +40,31 @@ namespace neonc {
             auto _type = (llvm::Type *)type.value().build(module);
             
             if (declare) {
-                auto alloca = module.get_builder()->CreateAlloca(_type);
+                // nothing is assigned to a variable after its declaration, so it is the ssa value it is
+                // initialized with, there is no stack slot to store to and no load on every read
+                llvm::Value * value = nullptr;
 
                 if (!nodes.empty()) {
-                    if (auto expr = std::dynamic_pointer_cast<Expression>(nodes.back()); expr) {
-                        auto built = expr->build(module, _type);
+                    if (auto expr = node_cast<Expression>(nodes.back()); expr) {
+                        value = expr->build(module, _type);
 
-                        if (built == nullptr)
+                        if (value == nullptr)
                             throw std::invalid_argument("ICE: expression returned nullptr");
-
-                        module.get_builder()->CreateStore(built, alloca);
                     }
                 } else {
-                    // bool
-                    if (_type == llvm::Type::getInt1Ty(*module.context)) module.get_builder()->CreateStore(module.get_builder()->getInt1(0), alloca);
-                    // integer types
-                    else if (_type == llvm::Type::getInt8Ty(*module.context)) module.get_builder()->CreateStore(module.get_builder()->getInt8(0), alloca);
-                    else if (_type == llvm::Type::getInt16Ty(*module.context)) module.get_builder()->CreateStore(module.get_builder()->getInt16(0), alloca);
-                    else if (_type == llvm::Type::getInt32Ty(*module.context)) module.get_builder()->CreateStore(module.get_builder()->getInt32(0), alloca);
-                    else if (_type == llvm::Type::getInt64Ty(*module.context)) module.get_builder()->CreateStore(module.get_builder()->getInt64(0), alloca);
-                    // floating point types
-                    else if (_type == llvm::Type::getFloatTy(*module.context))
-                        module.get_builder()->CreateStore(llvm::ConstantFP::get(llvm::Type::getFloatTy(*module.context), 0), alloca);
-                    else if (_type == llvm::Type::getDoubleTy(*module.context))
-                        module.get_builder()->CreateStore(llvm::ConstantFP::get(llvm::Type::getDoubleTy(*module.context), 0), alloca);
-                    //
+                    // bool, integer and floating point types
+                    if (_type->isIntegerTy() || _type->isFloatTy() || _type->isDoubleTy())
+                        value = llvm::Constant::getNullValue(_type);
                     else throw std::invalid_argument("ICE: unknown variable type to zero");
                 }
 
-                module.local_variables[identifier] = alloca;
+                if (slot >= module.local_variables.size())
+                    module.local_variables.resize(slot + 1);
+
+                module.local_variables[slot] = value;
             } else {
                 if (!nodes.empty()) {
-                    if (auto expr = std::dynamic_pointer_cast<Expression>(nodes.back()); expr) {
+                    if (auto expr = node_cast<Expression>(nodes.back()); expr) {
                         expr->build(module, _type);
                     }
                 }
@@ -83,8 +73,13 @@ namespace neonc {
             return nullptr;
         }
 
-        const std::string identifier;
+        bool get_declare() const {
+            return declare;
+        }
+
+        const Symbol identifier;
         std::optional<Type> type;
+        uint32_t slot = 0; // of a declared variable in its function, in order of declaration, filled in by the analyzer
     private:
         bool declare = true;
     };
@@ -0,0 +1,41 @@
+#include "visitor.h"
+
+namespace neonc {
+    namespace {
+        struct Dumper : Visitor<Dumper> {
+            template<typename T>
+            void operator()(const T * node, const uint32_t indentation) {
+                node->dump(indentation);
+            }
+        };
+
+        // only statements and functions are built on their own, operands are lowered by Expression
+        struct Builder : Visitor<Builder> {
+            template<typename T>
+            void operator()(T * node, Module & module) {
+                if constexpr (requires { node->build(module); })
+                    node->build(module);
+            }
+        };
+
+        struct Finalizer : Visitor<Finalizer> {
+            template<typename T>
+            void operator()(T * node, Module & module) {
+                if constexpr (requires { node->finalize(module); })
+                    node->finalize(module);
+            }
+        };
+    }
+
+    void dump_node(const Node * node, const uint32_t indentation) {
+        Dumper().visit(node, indentation);
+    }
+
+    void build_node(Node * node, Module & module) {
+        Builder().visit(node, module);
+    }
+
+    void finalize_node(Node * node, Module & module) {
+        Finalizer().visit(node, module);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <neonc.h>
+#include "node.h"
+#include "type.h"
+#include "argument.h"
+#include "expression.h"
+#include "variable.h"
+#include "return.h"
+#include "function.h"
+#include "root.h"
+
+namespace neonc {
+    // static dispatch over the kinds of nodes, `Derived` provides an operator() per node class it handles
+    // (or a template for all of them), visit() switches on the tag once and static_casts to the class,
+    // extra arguments are forwarded, constness of the visited node carries over to the cast
+    template<typename Derived, typename Result = void>
+    struct Visitor {
+        template<typename N, typename ... Args>
+        Result visit(N * node, Args && ... args) {
+            static_assert(std::is_same_v<std::remove_const_t<N>, Node>, "visit() takes a Node");
+
+            auto & self = static_cast<Derived &>(*this);
+
+            switch (node->id()) {
+            case NodeId::Root: return self(static_cast<as<N, Root> *>(node), std::forward<Args>(args)...);
+            case NodeId::Expression: return self(static_cast<as<N, Expression> *>(node), std::forward<Args>(args)...);
+            case NodeId::Operator: return self(static_cast<as<N, Operator> *>(node), std::forward<Args>(args)...);
+            case NodeId::Boolean: return self(static_cast<as<N, Boolean> *>(node), std::forward<Args>(args)...);
+            case NodeId::Call: return self(static_cast<as<N, Call> *>(node), std::forward<Args>(args)...);
+            case NodeId::Number: return self(static_cast<as<N, Number> *>(node), std::forward<Args>(args)...);
+            case NodeId::String: return self(static_cast<as<N, String> *>(node), std::forward<Args>(args)...);
+            case NodeId::Identifier: return self(static_cast<as<N, Identifier> *>(node), std::forward<Args>(args)...);
+            case NodeId::Argument: return self(static_cast<as<N, Argument> *>(node), std::forward<Args>(args)...);
+            case NodeId::Type: return self(static_cast<as<N, Type> *>(node), std::forward<Args>(args)...);
+            case NodeId::Variable: return self(static_cast<as<N, Variable> *>(node), std::forward<Args>(args)...);
+            case NodeId::Function: return self(static_cast<as<N, Function> *>(node), std::forward<Args>(args)...);
+            case NodeId::Return: return self(static_cast<as<N, Return> *>(node), std::forward<Args>(args)...);
+            case NodeId::None: break;
+            }
+
+            std::cerr << "ICE: visiting node without a kind" << std::endl;
+            exit(0);
+        }
+    private:
+        template<typename N, typename T>
+        using as = std::conditional_t<std::is_const_v<N>, const T, T>;
+    };
+}
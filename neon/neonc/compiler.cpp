@@ -2,44 +2,115 @@
 
 #include "util/measure.h"
 #include "util/cwd.h"
-#include "util/read_file.h"
+#include "source/source_manager.h"
+#include "source/diagnostics.h"
 #include "lexer/lexer.h"
 #include "parser/parser.h"
+#include "ast/cache.h"
 #include <neonc.h>
 #include "llvm/target.h"
 
 namespace neonc {
-    void build(const char * entry) {
-        auto measure = Measure();
+    namespace {
+        AbstractSyntaxTree parse(const FileId file, const uint32_t threads) {
+            auto parser = Parser(threads);
+
+            // large files are lexed and parsed on several threads, anything smaller streams tokens into the parser
+            if (source_manager().buffer(file).size() >= Lexer::PARALLEL_THRESHOLD)
+                return parser.parse_ast(Lexer(threads).Tokenize(file));
+
+            auto tokens = TokenStream(file);
+
+            return parser.parse_ast(tokens);
+        }
+
+        // loads, checks and lowers `entry` into a module of `target`, nullopt if the file has errors, they are printed
+        std::optional<Module> lower(const std::string & file_path, const char * entry, const Target & target, const BuildOptions & options, const bool dump) {
+            auto loaded = source_manager().load(file_path);
+
+            if (!loaded)
+                return std::nullopt;
+
+            const auto file = *loaded;
 
-        auto cwd = get_cwd();
+            auto cache = AstCache(get_cwd() + "/.neon/cache");
 
-        auto file_path = cwd + "/" + std::string(entry);
-        auto file = read_file(file_path);
+            // an unchanged file is loaded already analyzed, without being lexed or parsed
+            auto cached = cache.load(file);
+            auto ast = cached ? std::move(*cached) : parse(file, options.threads);
 
-        auto lexer = Lexer();
-        auto tokens = lexer.Tokenize(file_path, file);
-        for (auto tok : tokens) tok.dump();
-        std::cout << std::endl;
+            if (!ast.is_verified()) {
+                // every syntax error of the file is reported at once, the analyzer needs a complete tree
+                if (diagnostics().has_errors() || !ast.verify()) {
+                    diagnostics().flush();
 
-        auto parser = Parser();
-        auto ast = parser.parse_ast(file_path, tokens);
+                    return std::nullopt;
+                }
 
-        auto target = Target();
-        auto module = target.create_module(std::string(entry));
+                cache.store(file, ast);
+            }
 
-        ast.verify();
-        ast.dump();
-        std::cout << std::endl;
-        ast.build(module);
-        ast.finalize(module);
+            auto module = target.create_module(std::string(entry));
 
-        module.verify();
-        // target.optimize(module);
-        module.dump();
+            if (dump) {
+                ast.dump();
+                std::cout << std::endl;
+            }
 
-        target.module_to_object_file(module, file_path);
+            ast.build(module);
+            ast.finalize(module);
+
+            // literals are range checked against their types while lowering
+            if (diagnostics().has_errors()) {
+                diagnostics().flush();
+
+                return std::nullopt;
+            }
+
+            module.verify();
+
+            if (dump)
+                module.dump();
+
+            return module;
+        }
+    }
+
+    bool build(const char * entry, const BuildOptions & options) {
+        auto measure = Measure();
+
+        auto file_path = get_cwd() + "/" + std::string(entry);
+
+        auto target = Target(options.opt_level);
+        auto module = lower(file_path, entry, target, options, true);
+
+        if (!module)
+            return false;
+
+        if (!options.output.empty()) {
+            if (!target.link(*module, options.output, options.threads))
+                return false;
+        } else if (!target.compile(*module, file_path, options.threads)) {
+            return false;
+        }
 
         measure.finish("FINISHED IN:");
+
+        return true;
+    }
+
+    std::optional<int> run(const char * entry, const std::vector<std::string> & arguments, const BuildOptions & options) {
+        auto measure = Measure();
+
+        auto file_path = get_cwd() + "/" + std::string(entry);
+
+        // stdout belongs to the program, nothing is dumped
+        auto target = Target(options.opt_level);
+        auto module = lower(file_path, entry, target, options, false);
+
+        if (!module)
+            return std::nullopt;
+
+        return target.run(*module, entry, arguments, [&] { measure.finish("STARTED IN:", std::cerr); });
     }
 }
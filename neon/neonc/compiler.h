@@ -1,5 +1,21 @@
 #pragma once
 
+#include "llvm/opt_level.h"
+#include <optional>
+#include <string>
+#include <vector>
+
 namespace neonc {
-    void build(const char * entry);
+    struct BuildOptions {
+        OptLevel opt_level = OptLevel::O0;
+        uint32_t threads = 0; // for lexing, parsing and the backend, 0 is one per core
+        std::string output; // executable linked in process, empty writes `<entry>.o` (or `.a`) to link by hand
+    };
+
+    // false if the file has errors, they are printed and the process keeps running
+    bool build(const char * entry, const BuildOptions & options = {});
+
+    // compiles `entry` in process and runs its main with `arguments`, nothing is written, the time until main starts
+    // is reported on stderr, the exit code of main, nullopt if the file has errors or cannot be run
+    std::optional<int> run(const char * entry, const std::vector<std::string> & arguments, const BuildOptions & options = {});
 }
@@ -1,74 +1,67 @@
 #include "lexer.h"
-
-#define cmp(s, t) if (ident == s) return t;
+#include "../util/parallel.h"
 
 namespace neonc {
-    static void correct_buffer_for_string(std::string & str) {
-        std::vector<std::tuple<std::string, std::string>> v = {
-            {"\\n", "\n"},
-            {"\\t", "\t"},
-            {"\\r", "\r"},
-            {"\\b", "\b"},
-            {"\\f", "\f"},
-            {"\\a", "\a"},
-            {"\\v", "\v"},
-        };
+    inline void throw_error(const FileId file, const uint32_t offset, const std::string_view value, const char * message) {
+        diagnostics().error(source_manager().location(file, offset), std::string(message) + ", found '" + std::string(value) + "'");
+    }
 
-        for (auto _v : v) {        
-            std::string::size_type pos = 0;
-            const std::string b = std::get<0>(_v);
-            const std::string a = std::get<1>(_v);
+    constexpr inline bool is_ident(char ch, bool include_nums = true) {
+        return include_nums ? (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_'
+            : (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+    }
 
-            while ((pos = str.find(b, pos)) != std::string::npos) {
-                str.replace(pos, b.length(), a);
-                pos += a.length();
-            }
-        }
+    constexpr inline bool is_number(char ch, bool include_underscore = true) {
+        return include_underscore ? (ch >= '0' && ch <= '9') || ch == '_' : ch >= '0' && ch <= '9';
     }
 
-    inline void throw_error(const std::string file_path, uint32_t line, uint32_t column, const char * value, const char * message) {
-        auto src = extract_from_file(file_path, line);
+    namespace {
+        struct Keyword {
+            std::string_view text;
+            TokenId token;
+        };
 
-        std::cout << ColorRed << BoldFont << "Error" << ColorCyan << " -> " << ColorReset << file_path << "\n";
-        std::cout << ColorCyan << line << " | " << ColorReset << src << "\n";
-        std::cout << ColorCyan << std::string(std::to_string(line).length(), ' ') << " |";
+        constexpr std::array<Keyword, 6> KEYWORDS = {{
+            { "fn", TokenId::FN },
+            { "var", TokenId::VAR },
+            { "true", TokenId::TRUE },
+            { "false", TokenId::FALSE },
+            { "return", TokenId::RET },
+            { "pub", TokenId::PUB },
+        }};
+
+        // first + last character is collision free over KEYWORDS, checked by the static_assert below
+        constexpr inline uint32_t keyword_hash(std::string_view ident) {
+            return (uint8_t(ident.front()) + uint8_t(ident.back())) & 15;
+        }
 
-        std::cout << ColorRed << std::string(column, ' ') << "^ " << message << ", found '" << value << "'" << ColorReset << "\n" << std::endl;
+        constexpr std::array<Keyword, 16> KEYWORD_TABLE = [] {
+            std::array<Keyword, 16> table;
 
-        exit(0);
-    }
+            for (auto & entry : table)
+                entry = { {}, TokenId::IDENT };
 
-    inline void add_token(std::vector<Token> & tokens, TokenId token, std::string value, uint64_t & line, uint64_t & column) {
-        tokens.push_back(Token {
-            token,
-            value,
-            { line, column - uint64_t(value.length()) + 1 }
-        });
+            for (auto & keyword : KEYWORDS)
+                table[keyword_hash(keyword.text)] = keyword;
 
-        if (token == TokenId::NEWLINE) {
-            line++;
-            column = 0;
-        }
-    }
+            return table;
+        }();
 
-    constexpr inline bool is_ident(char ch, bool include_nums = true) {
-        return include_nums ? (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_'
-            : (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
-    }
+        constexpr bool is_perfect_keyword_hash() {
+            for (auto & keyword : KEYWORDS)
+                if (KEYWORD_TABLE[keyword_hash(keyword.text)].text != keyword.text)
+                    return false;
 
-    constexpr inline bool is_number(char ch, bool include_underscore = true) {
-        return include_underscore ? (ch >= '0' && ch <= '9') || ch == '_' : ch >= '0' && ch <= '9';
+            return true;
+        }
+
+        static_assert(is_perfect_keyword_hash(), "keyword hash has collisions");
     }
 
-    constexpr inline TokenId resolve_ident(std::string ident) {
-        cmp("fn", TokenId::FN)
-        cmp("var", TokenId::VAR)
-        cmp("true", TokenId::TRUE)
-        cmp("false", TokenId::FALSE)
-        cmp("return", TokenId::RET)
-        cmp("pub", TokenId::PUB)
+    constexpr inline TokenId resolve_ident(std::string_view ident) {
+        const auto & entry = KEYWORD_TABLE[keyword_hash(ident)];
 
-        return TokenId::IDENT;
+        return entry.text == ident ? entry.token : TokenId::IDENT;
     }
 
     constexpr inline bool is_single(char ch) {
@@ -125,143 +118,661 @@ namespace neonc {
         return ch == ' ' || ch == '\t';
     }
 
-    const std::vector<Token> Lexer::Tokenize(const std::string file_path, std::string _input) const {
-        std::vector<Token> tokens;
-        std::string input = _input + " ";
-        long long cursor = 0;
-        std::string buffer = "";
+    namespace {
+        constexpr uint32_t NONE = LexState::NONE;
+
+        void append_utf8(std::string & out, const uint32_t code_point) {
+            if (code_point < 0x80) {
+                out += char(code_point);
+            } else if (code_point < 0x800) {
+                out += char(0xC0 | (code_point >> 6));
+                out += char(0x80 | (code_point & 0x3F));
+            } else if (code_point < 0x10000) {
+                out += char(0xE0 | (code_point >> 12));
+                out += char(0x80 | ((code_point >> 6) & 0x3F));
+                out += char(0x80 | (code_point & 0x3F));
+            } else {
+                out += char(0xF0 | (code_point >> 18));
+                out += char(0x80 | ((code_point >> 12) & 0x3F));
+                out += char(0x80 | ((code_point >> 6) & 0x3F));
+                out += char(0x80 | (code_point & 0x3F));
+            }
+        }
 
-        uint64_t line = 1, column = 0;
-        bool in_string = false;
-        int32_t indentation = 0;
-        uint32_t last_l_brace_l = 0, last_l_brace_c = 0;
+        // decodes the escape sequence whose backslash is at `cursor` into `out`,
+        // returns the offset following it or NONE if it is malformed
+        uint32_t decode_escape(const std::string_view input, const uint32_t cursor, std::string & out) {
+            if (cursor + 1 >= input.size())
+                return NONE;
+
+            switch (input[cursor + 1]) {
+            case 'n': out += '\n'; return cursor + 2;
+            case 't': out += '\t'; return cursor + 2;
+            case 'r': out += '\r'; return cursor + 2;
+            case 'b': out += '\b'; return cursor + 2;
+            case 'f': out += '\f'; return cursor + 2;
+            case 'a': out += '\a'; return cursor + 2;
+            case 'v': out += '\v'; return cursor + 2;
+            case '0': out += '\0'; return cursor + 2;
+            case '\\': out += '\\'; return cursor + 2;
+            case '\"': out += '\"'; return cursor + 2;
+            case 'x': { // \xNN, exactly two hex digits
+                if (cursor + 3 >= input.size())
+                    return NONE;
+
+                const unsigned high = llvm::hexDigitValue(input[cursor + 2]);
+                const unsigned low = llvm::hexDigitValue(input[cursor + 3]);
+
+                if (high > 15 || low > 15)
+                    return NONE;
+
+                out += char(high << 4 | low);
+
+                return cursor + 4;
+            }
+            case 'u': { // \u{N..NNNNNN}, a unicode scalar value written as utf-8
+                if (cursor + 2 >= input.size() || input[cursor + 2] != '{')
+                    return NONE;
 
-        long long __size = input.size();
-        while (1) {
-            if (__size <= cursor)
-                break;
+                uint32_t code_point = 0;
+                uint32_t i = cursor + 3;
 
-            if (in_string)
-                goto in_string_block;
+                for (; i < input.size() && i - cursor - 3 < 6 && llvm::isHexDigit(input[i]); i++)
+                    code_point = code_point << 4 | llvm::hexDigitValue(input[i]);
 
-            if (input[cursor] == '\n') {
-                add_token(tokens, TokenId::NEWLINE, "\n", line, column);
-                cursor++;
+                if (i == cursor + 3 || i >= input.size() || input[i] != '}')
+                    return NONE;
 
-                continue;
+                if (code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF))
+                    return NONE;
+
+                append_utf8(out, code_point);
+
+                return i + 1;
+            }
             }
 
-            if (input[cursor] == '\"') {
-                in_string = true;
-                cursor++;
-                column++;
+            return NONE;
+        }
 
-                continue;
+        constexpr inline uint8_t radix_of_prefix(char ch) {
+            switch (ch) {
+            case 'x': case 'X': return 16;
+            case 'o': case 'O': return 8;
+            case 'b': case 'B': return 2;
             }
 
-            if (is_ident(input[cursor], false)) {
-                while (buffer.length() < 1 ? is_ident(input[cursor], false) : is_ident(input[cursor])) {
-                    buffer += input[cursor];
-                    column++;
-                    cursor++;
+            return 10;
+        }
+
+        // digits of an integer literal with `_` separators, nullopt if a digit does not belong to `radix`
+        std::optional<llvm::APInt> decode_integer(const std::string_view text, const uint8_t radix) {
+            llvm::SmallString<64> digits;
+
+            uint64_t small = 0;
+            bool overflow = false;
+
+            for (const char ch : text) {
+                if (ch == '_')
+                    continue;
+
+                const auto digit = llvm::hexDigitValue(ch);
+
+                if (digit >= radix)
+                    return std::nullopt;
+
+                digits.push_back(ch);
+
+                overflow |= __builtin_mul_overflow(small, radix, &small) || __builtin_add_overflow(small, digit, &small);
+            }
+
+            if (digits.empty())
+                return std::nullopt;
+
+            // anything that fits into 64 bits skips the string conversion of APInt
+            if (!overflow)
+                return llvm::APInt(std::max(1u, 64 - uint32_t(llvm::countLeadingZeros(small))), small);
+
+            auto value = llvm::APInt(llvm::APInt::getBitsNeeded(digits, radix), digits, radix);
+
+            return value.trunc(std::max(1u, value.getActiveBits()));
+        }
+
+        std::optional<llvm::APFloat> decode_floating(const std::string_view text) {
+            llvm::SmallString<64> digits;
+
+            for (const char ch : text)
+                if (ch != '_')
+                    digits.push_back(ch);
+
+            // up to 15 significant digits and 22 fraction digits both the mantissa and the power of ten
+            // are exact doubles, so a single division rounds correctly and the slow path is not needed
+            uint64_t mantissa = 0;
+            uint32_t significant = 0;
+            int32_t fraction = -1;
+
+            for (const char ch : digits) {
+                if (ch == '.') {
+                    fraction = 0;
+
+                    continue;
                 }
 
-                add_token(tokens, resolve_ident(buffer), buffer, line, column);
+                if (mantissa > 0 || ch != '0')
+                    significant++;
+
+                mantissa = mantissa * 10 + (ch - '0');
+
+                if (fraction >= 0)
+                    fraction++;
+            }
+
+            if (significant <= 15 && fraction <= 22) {
+                static constexpr double powers[] = {
+                    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+                };
+
+                return llvm::APFloat(double(mantissa) / powers[std::max(0, fraction)]);
+            }
+
+            auto value = llvm::APFloat(llvm::APFloat::IEEEdouble());
+            auto status = value.convertFromString(digits, llvm::APFloat::rmNearestTiesToEven);
+
+            if (!status) {
+                llvm::consumeError(status.takeError());
+
+                return std::nullopt;
+            }
 
-                buffer.clear();
+            if (*status & llvm::APFloat::opOverflow)
+                return std::nullopt;
 
-                cursor--;
-            } else if (is_number(input[cursor], false)) {
-                bool is_floating_point = false;
-    num:
-                while (buffer.length() < 1 ? is_number(input[cursor], false) : is_number(input[cursor])) {
-                    buffer += input[cursor];
-                    column++;
+            return value;
+        }
+
+        // lexes the tokens starting in [cursor, end), a string literal that starts before `end` is
+        // read to its closing quote even past `end`, identifiers are turned into symbols by `intern`,
+        // after every token `stop` is asked whether enough was lexed, returns where lexing ended
+        template<typename Intern, typename Stop>
+        uint32_t lex_range(TokenBuffer & tokens, const std::string_view input, uint32_t cursor, const uint32_t end, LexState & state, Intern && intern, Stop && stop) {
+            const char * data = input.data();
+            const uint32_t size = input.size();
+
+            const auto & scanner = scan();
+
+            while (cursor < end) {
+                const char ch = input[cursor];
+
+                if (ch == '\n') {
+                    state.flags |= TokenBuffer::NEWLINE_BEFORE;
                     cursor++;
+
+                    continue;
                 }
 
-                if (input[cursor] == '.' && is_number(input[cursor + 1])) {
-                    buffer += input[cursor];
+                if (ch == '\"') {
+                    const uint32_t start = ++cursor;
+
+                    // escapes are decoded as the scanner reaches them, the runs between them are copied once
+                    std::string decoded;
+                    uint32_t run = start;
+                    bool escaped = false;
 
+                    while (true) {
+                        cursor = scanner.string(data, cursor, size);
+
+                        if (cursor >= size || input[cursor] == '\"')
+                            break;
+
+                        decoded.append(data + run, cursor - run);
+                        escaped = true;
+
+                        if (const uint32_t next = decode_escape(input, cursor, decoded); next != NONE) {
+                            cursor = next;
+                        } else {
+                            state.fail(cursor, std::min(2u, size - cursor), "invalid escape sequence");
+
+                            cursor = std::min(cursor + 2, size);
+                        }
+
+                        run = cursor;
+                    }
+
+                    if (cursor >= size)
+                        return cursor;
+
+                    // only literals with escapes get their own storage, everything else stays a view into the source
+                    if (escaped) {
+                        decoded.append(data + run, cursor - run);
+
+                        tokens.push_literal(TokenId::STRING, start, cursor - start, state.flags, std::move(decoded));
+                    } else {
+                        tokens.push(TokenId::STRING, start, cursor - start, state.flags);
+                    }
+
+                    state.flags = 0;
                     cursor++;
-                    column++;
-                    is_floating_point = true;
 
-                    goto num;
+                    if (stop(tokens))
+                        return cursor;
+
+                    continue;
                 }
 
-                add_token(tokens, is_floating_point ? TokenId::FLOATING_NUMBER : TokenId::NUMBER, buffer, line, column);
+                const uint32_t start = cursor;
+
+                if (is_ident(ch, false)) {
+                    cursor = scanner.ident(data, cursor, size);
 
-                buffer.clear();
+                    const auto ident = input.substr(start, cursor - start);
 
-                cursor--;
-            } else if (is_single(input[cursor])) {
-                column++;
+                    if (auto token = resolve_ident(ident); token != TokenId::IDENT) {
+                        tokens.push(token, start, cursor - start, state.flags);
+                    } else {
+                        tokens.push_ident(intern(ident), start, cursor - start, state.flags);
+                    }
+                } else if (is_number(ch, false)) {
+                    const uint8_t radix = ch == '0' && cursor + 1 < size ? radix_of_prefix(input[cursor + 1]) : 10;
+                    bool is_floating_point = false;
+
+                    if (radix != 10) {
+                        cursor = scanner.ident(data, cursor + 2, size); // letters too, so that bad digits are reported
+                    } else {
+                        while (true) {
+                            cursor = scanner.number(data, cursor, size);
+
+                            if (!is_floating_point && cursor + 1 < size && input[cursor] == '.' && is_number(input[cursor + 1])) {
+                                cursor++;
+                                is_floating_point = true;
+
+                                continue;
+                            }
+
+                            break;
+                        }
+                    }
 
-                add_token(tokens, resolve_single(input[cursor]), std::string(1, input[cursor]), line, column);
+                    const auto text = input.substr(start, cursor - start);
+
+                    if (is_floating_point) {
+                        if (auto value = decode_floating(text); value) {
+                            tokens.push_literal(TokenId::FLOATING_NUMBER, start, cursor - start, state.flags, std::move(*value));
+                        } else {
+                            state.fail(start, cursor - start, "number literal out of range");
+                            tokens.push(TokenId::INVALID, start, cursor - start, state.flags);
+                        }
+                    } else if (auto value = decode_integer(radix != 10 ? text.substr(2) : text, radix); value) {
+                        tokens.push_integer(start, cursor - start, state.flags, std::move(*value));
+                    } else {
+                        state.fail(start, cursor - start, "invalid digit in number literal");
+                        tokens.push(TokenId::INVALID, start, cursor - start, state.flags);
+                    }
+                } else if (is_single(ch)) {
+                    tokens.push(resolve_single(ch), start, 1, state.flags);
 
-                if (input[cursor] == '{') {
-                    last_l_brace_l = line;
-                    last_l_brace_c = column;
+                    if (ch == '{') {
+                        state.last_l_brace = cursor;
 
-                    indentation++;
-                } else if (input[cursor] == '}') {
-                    indentation--;
+                        state.indentation++;
+                    } else if (ch == '}') {
+                        state.indentation--;
+                        state.min_indentation = std::min(state.min_indentation, state.indentation);
 
-                    if (indentation < 0) {
-                        throw_error(file_path, line, column + 1, "}", "unexpected closing delimiter");
+                        if (state.indentation < 0 && state.unexpected_r_brace == NONE)
+                            state.unexpected_r_brace = cursor;
                     }
+
+                    cursor++;
+                } else if (is_whitespace(ch)) { // ignore
+                    cursor = scanner.whitespace(data, cursor, size);
+
+                    continue;
+                } else {
+                    tokens.push(TokenId::INVALID, start, 1, state.flags);
+
+                    cursor++;
                 }
 
-                buffer.clear();
-            } else if (is_whitespace(input[cursor])) { // ignore
-                column++;
-            } else {
-                add_token(tokens, TokenId::INVALID, std::string(1, input[cursor]), line, column);
+                state.flags = 0;
+
+                if (stop(tokens))
+                    return cursor;
+            }
+
+            return cursor;
+        }
+
+        constexpr auto never = [](const TokenBuffer &) { return false; };
+
+        // a piece of the input ending in a newline, lexed on its own thread
+        struct Chunk {
+            Chunk(const FileId file, const uint32_t begin, const uint32_t end): tokens(file), begin(begin), end(end) {}
 
-                column++;
+            TokenBuffer tokens;
 
-                buffer.clear();
+            const uint32_t begin;
+            const uint32_t end;
+
+            bool skipped = false; // covered by a string literal of an earlier chunk, holds no tokens
+
+            uint32_t stop = 0; // where lexing ended, past `end` if the last literal runs into the next chunk
+
+            LexState state;
+
+            // identifiers get chunk local ids in order of first appearance, remapped to global symbols when stitching
+            llvm::StringMap<uint32_t> local;
+            std::vector<std::string_view> names;
+            std::vector<Symbol> symbols;
+        };
+
+        void lex_chunk(Chunk & chunk, const std::string_view input, const uint32_t cursor, const uint8_t flags) {
+            chunk.tokens.clear();
+            chunk.local.clear();
+            chunk.names.clear();
+            chunk.state = LexState();
+            chunk.state.flags = flags;
+
+            chunk.stop = lex_range(chunk.tokens, input, cursor, chunk.end, chunk.state, [&](const std::string_view name) {
+                auto [it, inserted] = chunk.local.try_emplace(llvm::StringRef(name.data(), name.size()), chunk.names.size());
+
+                if (inserted)
+                    chunk.names.push_back(name);
+
+                return Symbol { it->second };
+            }, never);
+        }
+    }
+
+    uint32_t Lexer::thread_count(const std::size_t size) const {
+        if (size < parallel_threshold)
+            return 1;
+
+        const uint32_t available = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+
+        // below about a megabyte per chunk starting the threads costs more than it saves
+        return std::max<std::size_t>(1, std::min<std::size_t>(available, size / (1024 * 1024)));
+    }
+
+    void TokenStream::lex(const uint32_t count) {
+        auto & names = interner();
+
+        const uint64_t target = uint64_t(tokens.size()) + count;
+        bool stopped = false;
+
+        cursor = lex_range(tokens, input, cursor, input.size(), state, [&](const std::string_view name) {
+            return names.intern(name);
+        }, [&](const TokenBuffer & lexed) {
+            return stopped = lexed.size() >= target;
+        });
+
+        // lexing goes on after a malformed literal, the parser sees an invalid token in its place
+        for (auto & error : state.errors)
+            throw_error(file, error.offset, input.substr(error.offset, error.length), error.message);
+
+        state.errors.clear();
+
+        if (state.unexpected_r_brace != NONE && !reported_r_brace) {
+            throw_error(file, state.unexpected_r_brace, "}", "unexpected closing delimiter");
+
+            reported_r_brace = true;
+        }
+
+        if (!stopped)
+            finish();
+    }
+
+    void TokenStream::finish() {
+        if (state.indentation > 0)
+            throw_error(file, state.last_l_brace, "{", "unclosed delimiter");
+
+        tokens.push(TokenId::ENDOFFILE, input.size(), 0, state.flags);
+
+        finished = true;
+    }
+
+    uint32_t TokenStream::fetch(const uint32_t index) {
+        if (index < base) {
+            std::cerr << "ICE: token " << index << " was already dropped by the token stream" << std::endl;
+            exit(0);
+        }
+
+        while (index - base >= tokens.size() && !finished) {
+            // whatever lies further behind than the lookbehind was consumed by the parser
+            const uint32_t keep = index > LOOKBEHIND ? index - LOOKBEHIND : 0;
+
+            if (keep > base) {
+                const uint32_t dropped = std::min(keep - base, tokens.size());
+
+                tokens.discard(dropped);
+                base += dropped;
             }
 
-            cursor++;
+            lex(BATCH);
+        }
 
-            continue;
-    in_string_block:
-            if (input[cursor] == '\"') {
-                in_string = false; 
+        return std::min(index - base, tokens.size() - 1);
+    }
 
-                correct_buffer_for_string(buffer);
+    TokenBuffer TokenStream::drain() {
+        if (!finished) {
+            // roughly one token per four bytes of source, avoids regrowing the vectors on large inputs
+            tokens.reserve(tokens.size() + (input.size() - cursor) / 4 + 1);
 
-                add_token(tokens, TokenId::STRING, buffer, line, column);
+            lex(std::numeric_limits<uint32_t>::max());
+        }
 
-                buffer = "";
+        return std::move(tokens);
+    }
 
-                cursor++;
-                column++;
-            } else {
-                buffer += input[cursor];
+    TokenBuffer Lexer::Tokenize(const FileId file) const {
+        if (thread_count(source_manager().buffer(file).size()) > 1)
+            return tokenize_parallel(file);
 
-                cursor++;
-                column++;
+        return TokenStream(file).drain();
+    }
 
-                if (input[cursor] == '\n') {
-                    line++;
-                    column = 0;
-                }
+    // the input is cut after newlines into one chunk per thread and every chunk is lexed speculatively,
+    // as if it started outside of a string, the chunks that actually start inside of a multi line literal
+    // are lexed again from where the literal ends, identifiers are interned per chunk and merged in
+    // chunk order so symbol ids match the sequential path
+    TokenBuffer Lexer::tokenize_parallel(const FileId file) const {
+        const auto input = source_manager().buffer(file);
+        const uint32_t size = input.size();
+        const uint32_t count = thread_count(size);
+
+        std::deque<Chunk> chunks;
+
+        for (uint32_t i = 0, begin = 0; i < count && begin < size; i++) {
+            uint32_t end = size;
+
+            if (i + 1 < count) {
+                const auto newline = input.find('\n', std::max<uint64_t>(begin, uint64_t(size) * (i + 1) / count));
+
+                end = newline == std::string_view::npos ? size : newline + 1;
+            }
+
+            chunks.emplace_back(file, begin, end);
+            begin = end;
+        }
+
+        parallel_for(chunks.size(), [&](const uint32_t i) {
+            auto & chunk = chunks[i];
+
+            chunk.tokens.reserve((chunk.end - chunk.begin) / 4 + 1);
+
+            lex_chunk(chunk, input, chunk.begin, chunk.begin > 0 ? TokenBuffer::NEWLINE_BEFORE : 0);
+        });
+
+        // the guess only holds if the previous chunk stopped exactly at the start of this one, otherwise
+        // one of its string literals ran into this chunk and lexing resumes after the closing quote
+        for (uint32_t i = 1, cursor = chunks[0].stop; i < chunks.size(); i++) {
+            auto & chunk = chunks[i];
+
+            if (cursor >= chunk.end) {
+                chunk.tokens.clear();
+                chunk.names.clear();
+                chunk.state = LexState();
+                chunk.skipped = true;
+
+                continue;
             }
+
+            if (cursor != chunk.begin)
+                lex_chunk(chunk, input, cursor, 0);
+
+            cursor = chunk.stop;
         }
 
-        if (indentation > 0) {
-            throw_error(file_path, last_l_brace_l, last_l_brace_c + 1, "{", "unclosed delimiter");
+        // malformed literals are reported by the sequential path
+        for (auto & chunk : chunks)
+            if (!chunk.state.errors.empty())
+                return Lexer(1).Tokenize(file);
+
+        // brace balance is a prefix sum over the chunks, on a mismatch the sequential path reports the error
+        int32_t indentation = 0;
+
+        for (auto & chunk : chunks) {
+            if (indentation + chunk.state.min_indentation < 0)
+                return Lexer(1).Tokenize(file);
+
+            indentation += chunk.state.indentation;
         }
 
-        tokens.push_back(Token {
-            TokenId::ENDOFFILE,
-            "",
-            { line, 0 }
+        if (indentation > 0)
+            return Lexer(1).Tokenize(file);
+
+        auto & names = interner();
+
+        uint32_t total = 0;
+        uint8_t flags = 0;
+
+        for (auto & chunk : chunks) {
+            chunk.symbols.reserve(chunk.names.size());
+
+            for (auto name : chunk.names)
+                chunk.symbols.push_back(names.intern(name));
+
+            total += chunk.tokens.size();
+
+            if (!chunk.skipped)
+                flags = chunk.state.flags;
+        }
+
+        TokenBuffer tokens(file);
+        tokens.resize(total + 1);
+
+        std::vector<uint32_t> at(chunks.size(), 0);
+        std::vector<uint32_t> literals(chunks.size(), 0);
+
+        for (uint32_t i = 0; i < chunks.size(); i++) {
+            if (i > 0)
+                at[i] = at[i - 1] + chunks[i - 1].tokens.size();
+
+            literals[i] = tokens.adopt_literals(chunks[i].tokens);
+        }
+
+        parallel_for(chunks.size(), [&](const uint32_t i) {
+            tokens.write(at[i], chunks[i].tokens, chunks[i].symbols, literals[i]);
         });
 
+        tokens.set(total, TokenId::ENDOFFILE, size, 0, flags);
+
         return tokens;
     }
+
+    // the lexer carries no state from one token to the next except the newline flag, which every token
+    // stores, so lexing can restart at any token boundary in front of the edit and stops as soon as it
+    // produces a token that starts where an old one did behind the edit, with the same kind and flags
+    //
+    // only a window behind the edit is copied out of the source and lexed, it doubles until lexing syncs
+    // up or reaches the end of the file, so an edit costs about the size of the damage and not of the file
+    std::optional<TokenChange> Lexer::Relex(TokenBuffer & tokens, const Edit & edit) const {
+        static constexpr uint32_t WINDOW = 4096;
+
+        const auto file = tokens.get_file();
+
+        // first token that touches the edit, the one in front of it is relexed as well because
+        // numbers look one character past their end
+        const uint32_t touched = partition_near(tokens.size(), tokens.gap(), [&](const uint32_t i) {
+            return tokens.source_end(i) < edit.offset;
+        });
+
+        const uint32_t first = touched > 0 ? touched - 1 : 0;
+        const uint32_t cursor = first > 0 ? tokens.source_end(first - 1) : 0;
+
+        if (!source_manager().edit(file, edit.offset, edit.length, edit.text))
+            return std::nullopt;
+
+        const int64_t delta = int64_t(edit.text.size()) - int64_t(edit.length);
+        const uint32_t size = source_manager().size(file);
+        const uint32_t damage = edit.offset + edit.text.size();
+
+        auto & names = interner();
+
+        TokenBuffer relexed(file);
+        std::string input;
+        LexState state;
+        uint32_t old;
+        bool synced = false;
+
+        for (uint32_t window = WINDOW; ; window *= 2) {
+            // offsets in the window are relative to `cursor`
+            const uint32_t end = std::min<uint64_t>(size, uint64_t(damage) + window);
+
+            input.clear();
+            source_manager().copy(file, cursor, end, input);
+
+            relexed.clear();
+            old = touched;
+            state = LexState();
+
+            lex_range(relexed, input, 0, input.size(), state, [&](const std::string_view name) {
+                return names.intern(name);
+            }, [&](const TokenBuffer & fresh) {
+                const uint32_t last = fresh.size() - 1;
+                const uint32_t begin = cursor + fresh.source_begin(last);
+
+                // a token running into the end of the window may continue behind it
+                if (begin < damage || (end < size && cursor + fresh.source_end(last) >= end))
+                    return false;
+
+                while (old < tokens.size() && tokens.source_begin(old) + delta < begin)
+                    old++;
+
+                synced = old < tokens.size()
+                    && tokens.source_begin(old) + delta == begin
+                    && tokens.kind(old) == fresh.kind(last)
+                    && tokens.flags_of(old) == fresh.flags_of(last)
+                    && tokens.length(old) == fresh.length(last);
+
+                return synced;
+            });
+
+            if (synced) {
+                relexed.pop();
+
+                break;
+            }
+
+            if (end == size) {
+                relexed.push(TokenId::ENDOFFILE, input.size(), 0, state.flags);
+                old = tokens.size();
+
+                break;
+            }
+        }
+
+        // malformed literals of the relexed tokens are reported like the token stream does, the token relexing
+        // synced up on is the old one and was reported before
+        for (auto & error : state.errors)
+            if (!synced || cursor + error.offset < tokens.source_begin(old) + delta)
+                throw_error(file, cursor + error.offset, std::string_view(input).substr(error.offset, error.length), error.message);
+
+        const TokenChange change = { first, old - first, relexed.size() };
+
+        tokens.splice(first, old - first, relexed, delta, cursor);
+
+        return change;
+    }
 }
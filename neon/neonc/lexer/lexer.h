@@ -1,14 +1,111 @@
 #pragma once
 
-#include "token.h"
-#include "../util/extract_from_file.h"
+#include "token_buffer.h"
+#include "scan.h"
+#include "../source/diagnostics.h"
 #include <neonc.h>
 
 namespace neonc {
+    // `length` bytes at `offset` were replaced by `text`
+    struct Edit {
+        uint32_t offset;
+        uint32_t length;
+        std::string_view text;
+    };
+
+    // tokens [first, first + removed) of the old stream were replaced by [first, first + inserted)
+    struct TokenChange {
+        uint32_t first;
+        uint32_t removed;
+        uint32_t inserted;
+    };
+
+    // everything the lexer carries from one byte to the next apart from the cursor
+    struct LexState {
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        uint8_t flags = 0;
+
+        int32_t indentation = 0;
+        int32_t min_indentation = 0;
+
+        uint32_t last_l_brace = NONE;
+        uint32_t unexpected_r_brace = NONE; // first '}' that closed more than was opened
+
+        struct Error {
+            uint32_t offset;
+            uint32_t length;
+            const char * message;
+        };
+
+        // malformed literals, the lexer keeps going and the caller decides when to report them
+        std::vector<Error> errors;
+
+        void fail(const uint32_t offset, const uint32_t length, const char * message) {
+            errors.push_back({ offset, length, message });
+        }
+    };
+
+    // pull based lexer, tokens are lexed in small batches when the parser asks for them and the
+    // ones it has moved past are dropped, so memory is bounded by the window and not by the file
+    class TokenStream {
+    public:
+        static constexpr uint32_t BATCH = 256;
+        static constexpr uint32_t LOOKBEHIND = 4; // tokens kept in front of the one last asked for
+
+        TokenStream(const FileId file): file(file), input(source_manager().buffer(file)), tokens(file) {}
+
+        // makes token `index` available and returns its index in `buffer()`, the end of file token
+        // is returned for anything past it
+        uint32_t fetch(const uint32_t index);
+
+        // lexes the rest of the input and hands over every token that was not dropped yet
+        TokenBuffer drain();
+
+        const TokenBuffer & buffer() const {
+            return tokens;
+        }
+
+        FileId get_file() const {
+            return file;
+        }
+    private:
+        const FileId file;
+        const std::string_view input;
+
+        TokenBuffer tokens;
+        uint32_t base = 0; // stream index of tokens[0]
+
+        uint32_t cursor = 0;
+        LexState state;
+        bool finished = false;
+        bool reported_r_brace = false;
+
+        void lex(const uint32_t count);
+        void finish();
+    };
+
     class Lexer {
     public:
-        Lexer() = default;
+        // inputs of at least this many bytes are lexed in chunks on several threads
+        static constexpr std::size_t PARALLEL_THRESHOLD = 4 * 1024 * 1024;
+
+        // `threads` of 0 uses every hardware thread, 1 keeps lexing sequential
+        Lexer(const uint32_t threads = 0, const std::size_t parallel_threshold = PARALLEL_THRESHOLD)
+            : threads(threads), parallel_threshold(parallel_threshold) {}
+
+        TokenBuffer Tokenize(const FileId file) const;
+
+        // applies `edit` to the source of `tokens` and relexes only the damaged tokens in place,
+        // unlike Tokenize delimiters are not checked, the parser reports unbalanced braces,
+        // nothing if the source manager has no room left for the edited file
+        std::optional<TokenChange> Relex(TokenBuffer & tokens, const Edit & edit) const;
+    private:
+        const uint32_t threads;
+        const std::size_t parallel_threshold;
+
+        uint32_t thread_count(const std::size_t size) const;
 
-        const std::vector<Token> Tokenize(const std::string file_path, std::string input) const;
+        TokenBuffer tokenize_parallel(const FileId file) const;
     };
 }
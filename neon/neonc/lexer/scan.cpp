@@ -0,0 +1,333 @@
+#include "scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define NEONC_SCAN_X86
+    #include <immintrin.h>
+#endif
+
+namespace neonc {
+    namespace {
+        constexpr inline bool is_ident(char ch) {
+            return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_';
+        }
+
+        constexpr inline bool is_number(char ch) {
+            return (ch >= '0' && ch <= '9') || ch == '_';
+        }
+
+        // scalar
+
+        std::size_t scalar_whitespace(const char * data, std::size_t cursor, std::size_t size) {
+            while (cursor < size && (data[cursor] == ' ' || data[cursor] == '\t'))
+                cursor++;
+
+            return cursor;
+        }
+
+        std::size_t scalar_ident(const char * data, std::size_t cursor, std::size_t size) {
+            while (cursor < size && is_ident(data[cursor]))
+                cursor++;
+
+            return cursor;
+        }
+
+        std::size_t scalar_number(const char * data, std::size_t cursor, std::size_t size) {
+            while (cursor < size && is_number(data[cursor]))
+                cursor++;
+
+            return cursor;
+        }
+
+        std::size_t scalar_string(const char * data, std::size_t cursor, std::size_t size) {
+            while (cursor < size && data[cursor] != '\"' && data[cursor] != '\\')
+                cursor++;
+
+            return cursor;
+        }
+
+        void scalar_lines(const char * data, std::size_t cursor, std::size_t size, std::vector<uint32_t> & starts) {
+            for (; cursor < size; cursor++)
+                if (data[cursor] == '\n')
+                    starts.push_back(cursor + 1);
+        }
+
+        constexpr ScanFunctions scalar_functions = {
+            scalar_whitespace,
+            scalar_ident,
+            scalar_number,
+            scalar_string,
+            scalar_lines,
+        };
+
+#ifdef NEONC_SCAN_X86
+        // sse4.2, 16 bytes at a time through pcmpestri
+
+        constexpr int SSE42_RUN = _SIDD_UBYTE_OPS | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT;
+        constexpr int SSE42_FIND = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT;
+
+        __attribute__((target("sse4.2")))
+        std::size_t sse42_whitespace(const char * data, std::size_t cursor, std::size_t size) {
+            const __m128i set = _mm_setr_epi8(' ', '\t', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+            for (; cursor + 16 <= size; cursor += 16) {
+                const __m128i chunk = _mm_loadu_si128((const __m128i *)(data + cursor));
+                const int index = _mm_cmpestri(set, 2, chunk, 16, SSE42_RUN | _SIDD_CMP_EQUAL_ANY);
+
+                if (index < 16)
+                    return cursor + index;
+            }
+
+            return scalar_whitespace(data, cursor, size);
+        }
+
+        __attribute__((target("sse4.2")))
+        std::size_t sse42_ident(const char * data, std::size_t cursor, std::size_t size) {
+            const __m128i ranges = _mm_setr_epi8('a', 'z', 'A', 'Z', '0', '9', '_', '_', 0, 0, 0, 0, 0, 0, 0, 0);
+
+            for (; cursor + 16 <= size; cursor += 16) {
+                const __m128i chunk = _mm_loadu_si128((const __m128i *)(data + cursor));
+                const int index = _mm_cmpestri(ranges, 8, chunk, 16, SSE42_RUN | _SIDD_CMP_RANGES);
+
+                if (index < 16)
+                    return cursor + index;
+            }
+
+            return scalar_ident(data, cursor, size);
+        }
+
+        __attribute__((target("sse4.2")))
+        std::size_t sse42_number(const char * data, std::size_t cursor, std::size_t size) {
+            const __m128i ranges = _mm_setr_epi8('0', '9', '_', '_', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+            for (; cursor + 16 <= size; cursor += 16) {
+                const __m128i chunk = _mm_loadu_si128((const __m128i *)(data + cursor));
+                const int index = _mm_cmpestri(ranges, 4, chunk, 16, SSE42_RUN | _SIDD_CMP_RANGES);
+
+                if (index < 16)
+                    return cursor + index;
+            }
+
+            return scalar_number(data, cursor, size);
+        }
+
+        __attribute__((target("sse4.2")))
+        std::size_t sse42_string(const char * data, std::size_t cursor, std::size_t size) {
+            const __m128i set = _mm_setr_epi8('\"', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+            for (; cursor + 16 <= size; cursor += 16) {
+                const __m128i chunk = _mm_loadu_si128((const __m128i *)(data + cursor));
+                const int index = _mm_cmpestri(set, 2, chunk, 16, SSE42_FIND);
+
+                if (index < 16)
+                    return cursor + index;
+            }
+
+            return scalar_string(data, cursor, size);
+        }
+
+        __attribute__((target("sse4.2")))
+        void sse42_lines(const char * data, std::size_t cursor, std::size_t size, std::vector<uint32_t> & starts) {
+            const __m128i newline = _mm_set1_epi8('\n');
+
+            for (; cursor + 16 <= size; cursor += 16) {
+                const __m128i chunk = _mm_loadu_si128((const __m128i *)(data + cursor));
+                uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+
+                for (; mask; mask &= mask - 1)
+                    starts.push_back(cursor + __builtin_ctz(mask) + 1);
+            }
+
+            scalar_lines(data, cursor, size, starts);
+        }
+
+        constexpr ScanFunctions sse42_functions = {
+            sse42_whitespace,
+            sse42_ident,
+            sse42_number,
+            sse42_string,
+            sse42_lines,
+        };
+
+        // avx2, 32 bytes at a time, classes are built from byte compares and the first
+        // byte outside of the class is found with a movemask + ctz, vzeroupper is explicit
+        // because unoptimized builds do not insert it and the scalar lexer would pay the transition
+
+        __attribute__((target("avx2")))
+        std::size_t avx2_whitespace(const char * data, std::size_t cursor, std::size_t size) {
+            const __m256i space = _mm256_set1_epi8(' ');
+            const __m256i tab = _mm256_set1_epi8('\t');
+
+            for (; cursor + 32 <= size; cursor += 32) {
+                const __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + cursor));
+                const __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab));
+                const uint32_t mask = ~uint32_t(_mm256_movemask_epi8(match));
+
+                if (mask) {
+                    _mm256_zeroupper();
+
+                    return cursor + __builtin_ctz(mask);
+                }
+            }
+
+            _mm256_zeroupper();
+
+            return scalar_whitespace(data, cursor, size);
+        }
+
+        __attribute__((target("avx2")))
+        std::size_t avx2_ident(const char * data, std::size_t cursor, std::size_t size) {
+            const __m256i lower = _mm256_set1_epi8(0x20);
+            const __m256i a = _mm256_set1_epi8('a' - 1);
+            const __m256i z = _mm256_set1_epi8('z' + 1);
+            const __m256i zero = _mm256_set1_epi8('0' - 1);
+            const __m256i nine = _mm256_set1_epi8('9' + 1);
+            const __m256i underscore = _mm256_set1_epi8('_');
+
+            for (; cursor + 32 <= size; cursor += 32) {
+                const __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + cursor));
+                const __m256i folded = _mm256_or_si256(chunk, lower);
+
+                const __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(folded, a), _mm256_cmpgt_epi8(z, folded));
+                const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, zero), _mm256_cmpgt_epi8(nine, chunk));
+                const __m256i match = _mm256_or_si256(_mm256_or_si256(alpha, digit), _mm256_cmpeq_epi8(chunk, underscore));
+                const uint32_t mask = ~uint32_t(_mm256_movemask_epi8(match));
+
+                if (mask) {
+                    _mm256_zeroupper();
+
+                    return cursor + __builtin_ctz(mask);
+                }
+            }
+
+            _mm256_zeroupper();
+
+            return scalar_ident(data, cursor, size);
+        }
+
+        __attribute__((target("avx2")))
+        std::size_t avx2_number(const char * data, std::size_t cursor, std::size_t size) {
+            const __m256i zero = _mm256_set1_epi8('0' - 1);
+            const __m256i nine = _mm256_set1_epi8('9' + 1);
+            const __m256i underscore = _mm256_set1_epi8('_');
+
+            for (; cursor + 32 <= size; cursor += 32) {
+                const __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + cursor));
+                const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, zero), _mm256_cmpgt_epi8(nine, chunk));
+                const __m256i match = _mm256_or_si256(digit, _mm256_cmpeq_epi8(chunk, underscore));
+                const uint32_t mask = ~uint32_t(_mm256_movemask_epi8(match));
+
+                if (mask) {
+                    _mm256_zeroupper();
+
+                    return cursor + __builtin_ctz(mask);
+                }
+            }
+
+            _mm256_zeroupper();
+
+            return scalar_number(data, cursor, size);
+        }
+
+        __attribute__((target("avx2")))
+        std::size_t avx2_string(const char * data, std::size_t cursor, std::size_t size) {
+            const __m256i quote = _mm256_set1_epi8('\"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+
+            for (; cursor + 32 <= size; cursor += 32) {
+                const __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + cursor));
+                const __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash));
+                const uint32_t mask = uint32_t(_mm256_movemask_epi8(match));
+
+                if (mask) {
+                    _mm256_zeroupper();
+
+                    return cursor + __builtin_ctz(mask);
+                }
+            }
+
+            _mm256_zeroupper();
+
+            return scalar_string(data, cursor, size);
+        }
+
+        __attribute__((target("avx2")))
+        void avx2_lines(const char * data, std::size_t cursor, std::size_t size, std::vector<uint32_t> & starts) {
+            const __m256i newline = _mm256_set1_epi8('\n');
+
+            for (; cursor + 32 <= size; cursor += 32) {
+                const __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + cursor));
+                uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+
+                for (; mask; mask &= mask - 1)
+                    starts.push_back(cursor + __builtin_ctz(mask) + 1);
+            }
+
+            _mm256_zeroupper();
+
+            scalar_lines(data, cursor, size, starts);
+        }
+
+        constexpr ScanFunctions avx2_functions = {
+            avx2_whitespace,
+            avx2_ident,
+            avx2_number,
+            avx2_string,
+            avx2_lines,
+        };
+#endif
+
+        const ScanFunctions & functions_for(const ScanIsa isa) {
+#ifdef NEONC_SCAN_X86
+            switch (isa) {
+            case ScanIsa::AVX2: return avx2_functions;
+            case ScanIsa::SSE42: return sse42_functions;
+            case ScanIsa::Scalar: break;
+            }
+#else
+            (void)isa;
+#endif
+
+            return scalar_functions;
+        }
+
+        ScanIsa current_isa = detect_scan_isa();
+        const ScanFunctions * current_functions = &functions_for(current_isa);
+    }
+
+    ScanIsa detect_scan_isa() {
+#ifdef NEONC_SCAN_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+            return ScanIsa::AVX2;
+
+        if (__builtin_cpu_supports("sse4.2"))
+            return ScanIsa::SSE42;
+#endif
+
+        return ScanIsa::Scalar;
+    }
+
+    void use_scan_isa(const ScanIsa isa) {
+        current_isa = std::min(isa, detect_scan_isa());
+        current_functions = &functions_for(current_isa);
+    }
+
+    ScanIsa get_scan_isa() {
+        return current_isa;
+    }
+
+    const ScanFunctions & scan() {
+        return *current_functions;
+    }
+
+    std::ostream & operator<<(std::ostream & os, const ScanIsa isa) {
+        switch (isa) {
+            case ScanIsa::Scalar: return os << "scalar";
+            case ScanIsa::SSE42: return os << "sse4.2";
+            case ScanIsa::AVX2: return os << "avx2";
+        }
+
+        return os;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <neonc.h>
+
+namespace neonc {
+    enum class ScanIsa {
+        Scalar,
+        SSE42,
+        AVX2,
+    };
+
+    // each function returns the index of the first byte in [cursor, size) that ends the run, or size
+    struct ScanFunctions {
+        std::size_t (*whitespace)(const char * data, std::size_t cursor, std::size_t size); // ' ', '\t'
+        std::size_t (*ident)(const char * data, std::size_t cursor, std::size_t size); // [a-zA-Z0-9_]
+        std::size_t (*number)(const char * data, std::size_t cursor, std::size_t size); // [0-9_]
+        std::size_t (*string)(const char * data, std::size_t cursor, std::size_t size); // stops at '"' or '\\'
+
+        // appends the offset following every '\n' in [cursor, size) to `starts`
+        void (*lines)(const char * data, std::size_t cursor, std::size_t size, std::vector<uint32_t> & starts);
+    };
+
+    // best isa supported by the running cpu
+    ScanIsa detect_scan_isa();
+
+    // selects the scanning path used by the lexer, falls back to the detected isa if unsupported
+    void use_scan_isa(const ScanIsa isa);
+    ScanIsa get_scan_isa();
+
+    const ScanFunctions & scan();
+
+    std::ostream & operator<<(std::ostream & os, const ScanIsa isa);
+}
@@ -1,8 +1,10 @@
 #include "token.h"
 
+#include "../source/source_manager.h"
+
 namespace neonc {
     namespace {
-        static const std::string escape_string(const std::string & input_string) {
+        static const std::string escape_string(const std::string_view input_string) {
             std::ostringstream escaped_string;
             for (char current_char : input_string) {
                 switch (current_char) {
@@ -32,14 +34,12 @@ namespace neonc {
     }
 
     void Token::dump() const {
-        auto v = value;
-
-        if (v.empty()) {
+        if (value.empty()) {
             std::cout << ColorRed << token << ColorReset << std::endl;
 
             return;
         }
 
-        std::cout << ColorCyan << token << ColorReset << " \"" << escape_string(v) << "\" " << position.string() << std::endl;
+        std::cout << ColorCyan << token << ColorReset << " \"" << escape_string(value) << "\" " << source_manager().position(location).string() << std::endl;
     }
 }
@@ -3,15 +3,26 @@
 #include "../util/clicolor.h"
 #include "../types/tokenid.h"
 #include <neonc.h>
-#include "../types/position.h"
+#include "../types/source_loc.h"
+#include "../types/symbol.h"
 
 namespace neonc {
+    // decoded value of a number literal, integers are unsigned, a leading minus is a separate token
+    using NumberLiteral = std::variant<llvm::APInt, llvm::APFloat>;
+
+    // value owned by a token buffer, the decoded contents of a string with escapes or a number literal
+    using Literal = std::variant<std::string, llvm::APInt, llvm::APFloat>;
+
+    // a single token materialized from a TokenBuffer, used for diagnostics and by the parser once a token is accepted,
+    // trivially copyable, decoded number literals are read from the buffer instead
     struct Token {
         void dump() const;
 
         const TokenId token;
-        const std::string value;
+        const std::string_view value;
+
+        const SourceLoc location;
 
-        const Position position;
+        const Symbol symbol; // only set for identifiers
     };
 }
@@ -0,0 +1,264 @@
+#include "token_buffer.h"
+
+namespace neonc {
+    void TokenBuffer::reserve(const std::size_t tokens) {
+        kinds.reserve(tokens);
+        flags.reserve(tokens);
+        offsets.reserve(tokens);
+        lengths.reserve(tokens);
+        payloads.reserve(tokens);
+    }
+
+    void TokenBuffer::clear() {
+        kinds.clear();
+        flags.clear();
+        offsets.clear();
+        lengths.clear();
+        payloads.clear();
+        literals.clear();
+        free_literals.clear();
+        literals_ordered = true;
+    }
+
+    void TokenBuffer::resize(const std::size_t tokens) {
+        move_gap(size());
+
+        kinds.resize(tokens);
+        flags.resize(tokens);
+        offsets.resize(tokens);
+        lengths.resize(tokens);
+        payloads.resize(tokens);
+    }
+
+    void TokenBuffer::set(const uint32_t index, const TokenId kind, const uint32_t offset, const uint32_t length, const uint8_t _flags, const uint32_t payload) {
+        kinds[index] = kind;
+        flags[index] = _flags;
+        offsets[index] = offset;
+        lengths[index] = length;
+        payloads[index] = payload;
+    }
+
+    uint32_t TokenBuffer::adopt_literals(TokenBuffer & other) {
+        const uint32_t base = literals.size();
+
+        std::move(other.literals.begin(), other.literals.end(), std::back_inserter(literals));
+        other.literals.clear();
+
+        return base;
+    }
+
+    void TokenBuffer::write(const uint32_t at, const TokenBuffer & other, const std::vector<Symbol> & symbols, const uint32_t literal_base) {
+        for (uint32_t i = 0; i < other.size(); i++) {
+            const uint32_t payload = other.payloads[i];
+
+            kinds[at + i] = other.kinds[i];
+            flags[at + i] = other.flags[i];
+            offsets[at + i] = other.offset(i);
+            lengths[at + i] = other.lengths[i];
+
+            if (other.kinds[i] == TokenId::IDENT) {
+                payloads[at + i] = symbols[payload].id;
+            } else if (other.flags[i] & BOXED) {
+                payloads[at + i] = literal_base + payload;
+            } else {
+                payloads[at + i] = payload;
+            }
+        }
+    }
+
+    void TokenBuffer::move_gap(const uint32_t index) {
+        if (index == kinds.gap())
+            return;
+
+        kinds.move_gap(index);
+        flags.move_gap(index);
+        offsets.move_gap(index, [&](const uint32_t offset) { return end - offset; });
+        lengths.move_gap(index);
+        payloads.move_gap(index);
+    }
+
+    void TokenBuffer::close() {
+        move_gap(size());
+
+        kinds.close();
+        flags.close();
+        offsets.close();
+        lengths.close();
+        payloads.close();
+    }
+
+    void TokenBuffer::splice(const uint32_t first, const uint32_t count, TokenBuffer & replacement, const int64_t delta, const uint32_t base) {
+        move_gap(first);
+
+        // literals of the removed tokens are released and their slots taken by the new ones, an editing session
+        // holds about as many literals as the file does
+        for (uint32_t i = first; i < first + count; i++) {
+            if (flags[i] & BOXED) {
+                literals[payloads[i]] = Literal();
+                free_literals.push_back(payloads[i]);
+            }
+        }
+
+        kinds.erase(count);
+        flags.erase(count);
+        offsets.erase(count);
+        lengths.erase(count);
+        payloads.erase(count);
+
+        // the tokens behind the hole are counted from the end, moving it moves all of them
+        end += delta;
+
+        for (uint32_t i = 0; i < replacement.size(); i++) {
+            uint32_t payload = replacement.payloads[i];
+
+            if (replacement.flags[i] & BOXED) {
+                auto & literal = replacement.literals[payload];
+
+                if (free_literals.empty()) {
+                    payload = literals.size();
+                    literals.push_back(std::move(literal));
+                } else {
+                    payload = free_literals.back();
+                    free_literals.pop_back();
+                    literals[payload] = std::move(literal);
+                }
+
+                literals_ordered = false;
+            }
+
+            kinds.insert(replacement.kinds[i]);
+            flags.insert(replacement.flags[i]);
+            offsets.insert(base + replacement.offset(i));
+            lengths.insert(replacement.lengths[i]);
+            payloads.insert(payload);
+        }
+
+        replacement.literals.clear();
+    }
+
+    void TokenBuffer::pop() {
+        move_gap(size());
+
+        kinds.pop_back();
+        flags.pop_back();
+        offsets.pop_back();
+        lengths.pop_back();
+        payloads.pop_back();
+    }
+
+    void TokenBuffer::discard(const uint32_t count) {
+        move_gap(size());
+
+        kinds.erase_front(count);
+        flags.erase_front(count);
+        offsets.erase_front(count);
+        lengths.erase_front(count);
+        payloads.erase_front(count);
+
+        if (literals.empty())
+            return;
+
+        free_literals.clear();
+
+        // a spliced buffer has its literals in any order, they are gathered in token order once
+        if (!literals_ordered) {
+            std::vector<Literal> ordered;
+
+            for (uint32_t i = 0; i < size(); i++) {
+                if (flags[i] & BOXED) {
+                    ordered.push_back(std::move(literals[payloads[i]]));
+                    payloads[i] = ordered.size() - 1;
+                }
+            }
+
+            literals = std::move(ordered);
+            literals_ordered = true;
+
+            return;
+        }
+
+        // keep only the literals of the remaining tokens, compacted in place since they are in token order
+        uint32_t kept = 0;
+
+        for (uint32_t i = 0; i < size(); i++) {
+            if (flags[i] & BOXED) {
+                if (payloads[i] != kept)
+                    literals[kept] = std::move(literals[payloads[i]]);
+
+                payloads[i] = kept++;
+            }
+        }
+
+        literals.erase(literals.begin() + kept, literals.end());
+    }
+
+    void TokenBuffer::push(const TokenId kind, const uint32_t offset, const uint32_t length, const uint8_t _flags, const uint32_t payload) {
+        // lexing appends to buffers without a hole, only a spliced one has to close it first
+        if (kinds.has_gap()) [[unlikely]]
+            close();
+
+        kinds.push_back(kind);
+        flags.push_back(_flags);
+        offsets.push_back(offset);
+        lengths.push_back(length);
+        payloads.push_back(payload);
+    }
+
+    void TokenBuffer::push_ident(const Symbol symbol, const uint32_t offset, const uint32_t length, const uint8_t _flags) {
+        push(TokenId::IDENT, offset, length, _flags, symbol.id);
+    }
+
+    void TokenBuffer::push_literal(const TokenId kind, const uint32_t offset, const uint32_t length, const uint8_t _flags, Literal value) {
+        literals.push_back(std::move(value));
+
+        push(kind, offset, length, _flags | BOXED, literals.size() - 1);
+    }
+
+    void TokenBuffer::push_integer(const uint32_t offset, const uint32_t length, const uint8_t _flags, llvm::APInt value) {
+        if (value.getActiveBits() <= 32) {
+            push(TokenId::NUMBER, offset, length, _flags, value.getZExtValue());
+        } else {
+            push_literal(TokenId::NUMBER, offset, length, _flags, std::move(value));
+        }
+    }
+
+    std::string_view TokenBuffer::value(const uint32_t index) const {
+        if (kinds[index] == TokenId::STRING && flags[index] & BOXED)
+            return std::get<std::string>(literals[payloads[index]]);
+
+        return source_manager().buffer(file).substr(offset(index), lengths[index]);
+    }
+
+    llvm::APInt TokenBuffer::integer(const uint32_t index) const {
+        if (flags[index] & BOXED)
+            return std::get<llvm::APInt>(literals[payloads[index]]);
+
+        return llvm::APInt(32, payloads[index]);
+    }
+
+    llvm::APFloat TokenBuffer::floating(const uint32_t index) const {
+        return std::get<llvm::APFloat>(literals[payloads[index]]);
+    }
+
+    SourceLoc TokenBuffer::location(const uint32_t index) const {
+        return source_manager().location(file, offset(index));
+    }
+
+    Position TokenBuffer::position_at(const uint32_t offset) const {
+        return source_manager().position(file, offset);
+    }
+
+    Token TokenBuffer::get(const uint32_t index) const {
+        return Token {
+            kinds[index],
+            value(index),
+            location(index),
+            kinds[index] == TokenId::IDENT ? symbol(index) : Symbol {}
+        };
+    }
+
+    void TokenBuffer::dump() const {
+        for (uint32_t i = 0; i < size(); i++)
+            get(i).dump();
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "token.h"
+#include "../source/source_manager.h"
+#include "../util/gap_array.h"
+#include <neonc.h>
+
+namespace neonc {
+    // structure of arrays token storage, a token is an index into the parallel arrays,
+    // values are views into the source and positions are resolved from offsets on demand
+    // through the line table of the source manager
+    //
+    // the arrays share a hole at the last splice, offsets behind it are counted from the end of the
+    // source so that a splice never touches the tokens behind it
+    class TokenBuffer {
+    public:
+        static constexpr uint8_t NEWLINE_BEFORE = 1 << 0; // at least one newline between this and the previous token
+        static constexpr uint8_t BOXED = 1 << 1; // literal whose value is owned by the buffer, the payload indexes `literals`
+
+        TokenBuffer(const FileId file): file(file), end(source_manager().size(file)) {}
+
+        void reserve(const std::size_t tokens);
+        void clear();
+
+        // grows to `tokens` entries so that disjoint ranges can be filled from several threads with `write`
+        void resize(const std::size_t tokens);
+        void set(const uint32_t index, const TokenId kind, const uint32_t offset, const uint32_t length, const uint8_t flags, const uint32_t payload = 0);
+
+        // moves the boxed literals of `other` over and returns the index the first one landed at
+        uint32_t adopt_literals(TokenBuffer & other);
+
+        // copies `other` to [at, at + other.size()), identifier payloads are translated through `symbols`
+        // and boxed literals are expected at `literal_base`, as returned by `adopt_literals`
+        void write(const uint32_t at, const TokenBuffer & other, const std::vector<Symbol> & symbols, const uint32_t literal_base);
+
+        // replaces tokens [first, first + count) with `replacement`, whose offsets are relative to `base`, and moves
+        // the following tokens by `delta` bytes, costs the size of the change and its distance from the previous
+        // one, the slots of the boxed literals of removed tokens are reused
+        void splice(const uint32_t first, const uint32_t count, TokenBuffer & replacement, const int64_t delta, const uint32_t base);
+        void pop();
+
+        // drops the first `count` tokens, used by the token stream to bound its window
+        void discard(const uint32_t count);
+
+        void push(const TokenId kind, const uint32_t offset, const uint32_t length, const uint8_t flags, const uint32_t payload = 0);
+        void push_ident(const Symbol symbol, const uint32_t offset, const uint32_t length, const uint8_t flags);
+        void push_literal(const TokenId kind, const uint32_t offset, const uint32_t length, const uint8_t flags, Literal value);
+
+        // integer literals that fit are stored in the payload, everything else is boxed
+        void push_integer(const uint32_t offset, const uint32_t length, const uint8_t flags, llvm::APInt value);
+
+        FileId get_file() const {
+            return file;
+        }
+
+        uint32_t size() const {
+            return kinds.size();
+        }
+
+        // index of the token behind the last splice, where the next edit most likely lands
+        uint32_t gap() const {
+            return kinds.gap();
+        }
+
+        TokenId kind(const uint32_t index) const {
+            return kinds[index];
+        }
+
+        bool newline_before(const uint32_t index) const {
+            return flags[index] & NEWLINE_BEFORE;
+        }
+
+        uint32_t offset(const uint32_t index) const {
+            return index < offsets.gap() ? offsets[index] : end - offsets[index];
+        }
+
+        uint32_t length(const uint32_t index) const {
+            return lengths[index];
+        }
+
+        uint8_t flags_of(const uint32_t index) const {
+            return flags[index];
+        }
+
+        // byte range of the token in the source, including the quotes of strings
+        uint32_t source_begin(const uint32_t index) const {
+            return offset(index) - (kinds[index] == TokenId::STRING);
+        }
+
+        uint32_t source_end(const uint32_t index) const {
+            return offset(index) + lengths[index] + (kinds[index] == TokenId::STRING);
+        }
+
+        Symbol symbol(const uint32_t index) const {
+            return Symbol { payloads[index] };
+        }
+
+        // spelling of the token, the decoded contents for strings with escapes
+        std::string_view value(const uint32_t index) const;
+
+        // decoded value of NUMBER and FLOATING_NUMBER tokens
+        llvm::APInt integer(const uint32_t index) const;
+        llvm::APFloat floating(const uint32_t index) const;
+
+        SourceLoc location(const uint32_t index) const;
+        Position position_at(const uint32_t offset) const;
+
+        Token get(const uint32_t index) const;
+
+        void dump() const;
+    private:
+        FileId file;
+        uint32_t end; // size of the source, offsets behind the hole are stored as `end - offset`
+
+        GapArray<TokenId> kinds;
+        GapArray<uint8_t> flags;
+        GapArray<uint32_t> offsets;
+        GapArray<uint32_t> lengths;
+        GapArray<uint32_t> payloads; // symbol id of identifiers, index into `literals` when BOXED, else the value of small integers
+
+        std::vector<Literal> literals;
+        std::vector<uint32_t> free_literals; // slots in `literals` released by a splice
+        bool literals_ordered = true; // the literals are in token order, which a splice gives up
+
+        // moves the hole of every array in front of token `index`
+        void move_gap(const uint32_t index);
+        void close();
+    };
+}
@@ -0,0 +1,190 @@
+#include "linker.h"
+#include <sys/mman.h>
+#include <unistd.h>
+
+LLD_HAS_DRIVER(elf)
+
+namespace neonc {
+    namespace {
+        // installed as <prefix>/lib/neon/libneonrt.a next to <prefix>/bin/neon
+        constexpr auto RUNTIME = "libneonrt.a";
+
+        struct Platform {
+            const char * emulation;
+            const char * dynamic_linker;
+        };
+
+        std::optional<Platform> platform(const llvm::Triple & triple) {
+            if (!triple.isOSLinux())
+                return std::nullopt;
+
+            switch (triple.getArch()) {
+            case llvm::Triple::x86_64: return Platform{"elf_x86_64", "/lib64/ld-linux-x86-64.so.2"};
+            case llvm::Triple::aarch64: return Platform{"aarch64linux", "/lib/ld-linux-aarch64.so.1"};
+            default: return std::nullopt;
+            }
+        }
+
+        // where distributions keep crt1.o and libc, debian style multiarch directories first
+        std::vector<std::string> library_directories(const llvm::Triple & triple) {
+            const auto multiarch = triple.getArchName().str() + "-linux-gnu";
+
+            return {"/usr/lib/" + multiarch, "/lib/" + multiarch, "/usr/lib64", "/lib64", "/usr/lib", "/lib"};
+        }
+
+        // crtbegin and crtend come with gcc, in a directory per version, the newest one wins
+        std::optional<std::string> gcc_directory(const llvm::Triple & triple) {
+            std::optional<std::string> newest;
+            llvm::VersionTuple newest_version;
+
+            for (const auto & machine : {triple.getArchName().str() + "-linux-gnu", triple.str()}) {
+                std::error_code e;
+
+                for (llvm::sys::fs::directory_iterator it("/usr/lib/gcc/" + machine, e), end; !e && it != end; it.increment(e)) {
+                    llvm::VersionTuple version;
+
+                    if (version.tryParse(llvm::sys::path::filename(it->path())) || !llvm::sys::fs::exists(it->path() + "/crtbeginS.o"))
+                        continue;
+
+                    if (!newest || version > newest_version) {
+                        newest = it->path();
+                        newest_version = version;
+                    }
+                }
+            }
+
+            return newest;
+        }
+
+        std::optional<std::string> find(const std::vector<std::string> & directories, const std::string & name) {
+            for (const auto & directory : directories)
+                if (llvm::sys::fs::exists(directory + "/" + name))
+                    return directory + "/" + name;
+
+            return std::nullopt;
+        }
+
+        // an anonymous file in memory that lld opens by path like any other, it goes away with the descriptor
+        struct MemoryFile {
+            explicit MemoryFile(const llvm::MemoryBufferRef buffer) {
+                fd = memfd_create(buffer.getBufferIdentifier().str().c_str(), MFD_CLOEXEC);
+
+                if (fd < 0)
+                    return;
+
+                llvm::raw_fd_ostream stream(fd, false);
+                stream << buffer.getBuffer();
+                stream.flush();
+
+                if (stream.has_error()) {
+                    stream.clear_error();
+                    close(fd);
+                    fd = -1;
+                }
+            }
+
+            MemoryFile(const MemoryFile &) = delete;
+            MemoryFile & operator=(const MemoryFile &) = delete;
+
+            ~MemoryFile() {
+                if (fd >= 0)
+                    close(fd);
+            }
+
+            std::string path() const {
+                return "/proc/self/fd/" + std::to_string(fd);
+            }
+
+            int fd = -1;
+        };
+    }
+
+    bool link_executable(const llvm::Triple & triple, const std::vector<llvm::MemoryBufferRef> & objects, const std::string & out) {
+        const auto target = platform(triple);
+
+        if (!target) {
+            llvm::errs() << "Could not link for " << triple.str() << ", only x86_64 and aarch64 linux are supported\n";
+            return false;
+        }
+
+        const auto directories = library_directories(triple);
+
+        // position independent start files, every object is compiled as pic
+        std::array<std::string, 3> start;
+        const std::array<const char *, 3> start_names = {"Scrt1.o", "crti.o", "crtn.o"};
+
+        for (uint32_t i = 0; i < start.size(); i++) {
+            const auto path = find(directories, start_names[i]);
+
+            if (!path) {
+                llvm::errs() << "Could not find the c runtime file " << start_names[i] << "\n";
+                return false;
+            }
+
+            start[i] = *path;
+        }
+
+        const auto gcc = gcc_directory(triple);
+        const auto executable = llvm::sys::fs::getMainExecutable(nullptr, nullptr);
+        const auto runtime = llvm::sys::path::parent_path(llvm::sys::path::parent_path(executable)).str() + "/lib/neon/" + RUNTIME;
+
+        std::vector<std::unique_ptr<MemoryFile>> files;
+
+        for (const auto & object : objects) {
+            files.push_back(std::make_unique<MemoryFile>(object));
+
+            if (files.back()->fd < 0) {
+                llvm::errs() << "Could not create an in memory file for " << object.getBufferIdentifier() << ": " << std::strerror(errno) << "\n";
+                return false;
+            }
+        }
+
+        // the order gcc uses, start files around the objects and libraries
+        std::vector<std::string> args = {
+            "ld.lld",
+            "-o", out,
+            "-m", target->emulation,
+            "-pie",
+            "--eh-frame-hdr",
+            "-dynamic-linker", target->dynamic_linker,
+            start[0],
+            start[1],
+        };
+
+        if (gcc)
+            args.push_back(*gcc + "/crtbeginS.o");
+
+        for (const auto & directory : directories)
+            args.push_back("-L" + directory);
+
+        for (const auto & file : files)
+            args.push_back(file->path());
+
+        if (llvm::sys::fs::exists(runtime))
+            args.push_back(runtime);
+
+        args.push_back("-lc");
+
+        if (gcc)
+            args.push_back(*gcc + "/crtendS.o");
+
+        args.push_back(start[2]);
+
+        std::vector<const char *> argv;
+
+        for (const auto & arg : args)
+            argv.push_back(arg.c_str());
+
+        std::string errors;
+        llvm::raw_string_ostream error_stream(errors);
+
+        const auto result = lld::lldMain(argv, llvm::outs(), error_stream, {{lld::Gnu, &lld::elf::link}});
+
+        if (result.retCode != 0) {
+            llvm::errs() << "Could not link " << out << ":\n" << error_stream.str();
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <neonc.h>
+
+namespace neonc {
+    // links `objects` into the executable `out` with lld inside this process, together with the c runtime start
+    // files, libc and the neon runtime archive when one is installed next to the compiler, the objects are handed
+    // to lld from memory and never written to disk, false (after printing why) if it could not be linked
+    bool link_executable(const llvm::Triple & triple, const std::vector<llvm::MemoryBufferRef> & objects, const std::string & out);
+}
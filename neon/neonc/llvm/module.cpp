@@ -24,26 +24,22 @@ namespace neonc {
     }
 
     llvm::Function * Module::get_function() {
-        return std::get<0>(std::get<0>(functions[pointer]));
+        return functions[pointer].function;
     }
 
-    std::map<std::string, llvm::Value *> & Module::get_arguments() {
-        return std::get<1>(std::get<0>(functions[pointer]));
-    }
-    
-    std::shared_ptr<llvm::IRBuilder<>> Module::get_builder() {
-        return std::get<1>(functions[pointer]);
+    llvm::Value * Module::get_argument(const uint32_t index) {
+        return get_function()->getArg(index);
     }
 
-    llvm::Function * Module::get_function(const std::string & id) {
-        return std::get<0>(std::get<0>(functions[id]));
+    std::shared_ptr<llvm::IRBuilder<>> Module::get_builder() {
+        return functions[pointer].builder;
     }
 
-    std::map<std::string, llvm::Value *> & Module::get_arguments(const std::string & id) {
-        return std::get<1>(std::get<0>(functions[id]));
+    llvm::Function * Module::get_function(const uint32_t index) {
+        return functions[index].function;
     }
 
-    std::shared_ptr<llvm::IRBuilder<>> Module::get_builder(const std::string & id) {
-        return std::get<1>(functions[id]);
+    std::shared_ptr<llvm::IRBuilder<>> Module::get_builder(const uint32_t index) {
+        return functions[index].builder;
     }
 }
@@ -1,15 +1,23 @@
 #pragma once
 
 #include <neonc.h>
+#include "../types/symbol.h"
+#include "opt_level.h"
 
 namespace neonc {
     struct Module {
+        struct Function {
+            llvm::Function * function = nullptr;
+            std::shared_ptr<llvm::IRBuilder<>> builder; // nullptr for declarations
+        };
+
         Module(
             std::shared_ptr<llvm::LLVMContext> context,
             std::shared_ptr<llvm::Module> module,
             const std::string target_cpu,
-            const std::string target_features
-        ): context(context), module(module), target_cpu(target_cpu), target_features(target_features) {
+            const std::string target_features,
+            const OptLevel opt_level
+        ): context(context), module(module), target_cpu(target_cpu), target_features(target_features), opt_level(opt_level) {
             dummy_builder = std::make_shared<llvm::IRBuilder<>>(*context);
         }
 
@@ -18,23 +26,29 @@ namespace neonc {
 
         std::shared_ptr<llvm::IRBuilder<>> dummy_builder;
 
+        // of the function `pointer` is at
         llvm::Function * get_function();
-        std::map<std::string, llvm::Value *> & get_arguments();
+        llvm::Value * get_argument(const uint32_t index);
         std::shared_ptr<llvm::IRBuilder<>> get_builder();
-        llvm::Function * get_function(const std::string & id);
-        std::map<std::string, llvm::Value *> & get_arguments(const std::string & id);
-        std::shared_ptr<llvm::IRBuilder<>> get_builder(const std::string & id);
 
-        std::map<std::string, llvm::Value *> local_variables;
+        llvm::Function * get_function(const uint32_t index);
+        std::shared_ptr<llvm::IRBuilder<>> get_builder(const uint32_t index);
+
+        // values of the variables of the function being built, by slot, emptied before every function body
+        std::vector<llvm::Value *> local_variables;
 
-        std::string pointer;
-        // args ------------------------------------------------------|
-        std::map<std::string, std::tuple<std::tuple<llvm::Function *, std::map<std::string, llvm::Value *>>, std::shared_ptr<llvm::IRBuilder<>>>> functions;
+        // position of the function being built among the items of the root
+        uint32_t pointer = 0;
+        // by position among the items of the root, only entries of functions are filled
+        std::vector<Function> functions;
 
         std::shared_ptr<llvm::LLVMContext> context;
         std::shared_ptr<llvm::Module> module;
 
         const std::string target_cpu;
         const std::string target_features;
+
+        // functions are lowered differently for debugging than for the optimizer
+        const OptLevel opt_level;
     };
 }
@@ -0,0 +1,14 @@
+#include "opt_level.h"
+
+namespace neonc {
+    std::optional<OptLevel> parse_opt_level(const std::string_view flag) {
+        if (flag == "-O0") return OptLevel::O0;
+        if (flag == "-O1") return OptLevel::O1;
+        if (flag == "-O2") return OptLevel::O2;
+        if (flag == "-O3") return OptLevel::O3;
+        if (flag == "-Os") return OptLevel::Os;
+        if (flag == "-Oz") return OptLevel::Oz;
+
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace neonc {
+    // O0 keeps every function as written for debugging, O1 to O3 spend more compile time on speed,
+    // Os and Oz optimize for size
+    enum class OptLevel : uint8_t {
+        O0,
+        O1,
+        O2,
+        O3,
+        Os,
+        Oz,
+    };
+
+    // level named by a command line flag, `-O2` and so on
+    std::optional<OptLevel> parse_opt_level(const std::string_view flag);
+}
@@ -1,7 +1,80 @@
 #include "target.h"
+#include "../util/parallel.h"
+#include "linker.h"
 
 namespace neonc {
-    Target::Target() {
+    namespace {
+        llvm::CodeGenOpt::Level codegen_level(const OptLevel level) {
+            switch (level) {
+            case OptLevel::O0: return llvm::CodeGenOpt::None;
+            case OptLevel::O1: return llvm::CodeGenOpt::Less;
+            case OptLevel::O3: return llvm::CodeGenOpt::Aggressive;
+            default: return llvm::CodeGenOpt::Default;
+            }
+        }
+
+        llvm::OptimizationLevel pipeline_level(const OptLevel level) {
+            switch (level) {
+            case OptLevel::O1: return llvm::OptimizationLevel::O1;
+            case OptLevel::O2: return llvm::OptimizationLevel::O2;
+            case OptLevel::O3: return llvm::OptimizationLevel::O3;
+            case OptLevel::Os: return llvm::OptimizationLevel::Os;
+            case OptLevel::Oz: return llvm::OptimizationLevel::Oz;
+            default: return llvm::OptimizationLevel::O0;
+            }
+        }
+
+        // what the jit calls instead of `main`, it is compiled together with `main` and tells the host first
+        constexpr auto ENTRY = "__neon_start";
+        constexpr auto STARTED = "__neon_started";
+
+        // the jit runs `main` on the calling thread, one program at a time
+        const std::function<void()> * started_callback = nullptr;
+
+        void notify_started() {
+            if (started_callback)
+                (*started_callback)();
+        }
+
+        // int ENTRY(int argc, ptr argv) passes main as many of argc and argv as it declares, and returns what main
+        // returns, or 0 for a void main
+        bool build_entry(llvm::Module & module) {
+            auto main = module.getFunction("main");
+
+            if (main == nullptr || main->isDeclaration()) {
+                llvm::errs() << "Could not find function main\n";
+                return false;
+            }
+
+            auto & context = module.getContext();
+            auto i32 = llvm::Type::getInt32Ty(context);
+            auto ptr = llvm::PointerType::get(context, 0);
+
+            const auto params = main->getFunctionType()->params();
+            const auto result = main->getReturnType();
+            const std::array<llvm::Type *, 2> c_params = {i32, ptr};
+
+            if (params.size() > c_params.size() || !std::equal(params.begin(), params.end(), c_params.begin()) || !(result->isVoidTy() || result->isIntegerTy())) {
+                llvm::errs() << "Could not run main, it has to be main([argc: i32, [argv: str]]) with an integer or no result\n";
+                return false;
+            }
+
+            auto entry = llvm::Function::Create(llvm::FunctionType::get(i32, c_params, false), llvm::Function::ExternalLinkage, ENTRY, module);
+            auto started = module.getOrInsertFunction(STARTED, llvm::FunctionType::get(llvm::Type::getVoidTy(context), false));
+
+            llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", entry));
+            std::array<llvm::Value *, 2> arguments = {entry->getArg(0), entry->getArg(1)};
+
+            builder.CreateCall(started);
+            auto code = builder.CreateCall(main, llvm::ArrayRef<llvm::Value *>(arguments).take_front(params.size()));
+
+            builder.CreateRet(result->isVoidTy() ? builder.getInt32(0) : builder.CreateIntCast(code, i32, !result->isIntegerTy(1)));
+
+            return true;
+        }
+    }
+
+    Target::Target(const OptLevel opt_level): opt_level(opt_level) {
         context = std::make_shared<llvm::LLVMContext>();
     
         llvm::InitializeAllTargetInfos();
@@ -21,61 +94,27 @@ namespace neonc {
             return;
         }
 
-        auto cpu = llvm::sys::getHostCPUName();
+        target_cpu = llvm::sys::getHostCPUName();
+        target_machine = create_target_machine();
+
+        target_features = target_machine->getTargetFeatureString();
+    }
+
+    std::unique_ptr<llvm::TargetMachine> Target::create_target_machine() const {
         auto features = "";
 
         llvm::TargetOptions opt;
         auto tm = target->createTargetMachine(
             target_triple,
-            cpu,
+            target_cpu,
             features,
             opt,
             llvm::Reloc::PIC_,
             llvm::CodeModel::Medium,
-            llvm::CodeGenOpt::None
+            codegen_level(opt_level)
         );
 
-        target_machine = std::unique_ptr<llvm::TargetMachine>(tm);
-
-        target_features = target_machine->getTargetFeatureString();
-        target_cpu = target_machine->getTargetCPU();
-
-        //
-
-        pass = std::make_shared<Pass>();
-
-        pass->fpm = std::make_shared<llvm::FunctionPassManager>();
-        pass->lam = std::make_shared<llvm::LoopAnalysisManager>();
-        pass->fam = std::make_shared<llvm::FunctionAnalysisManager>();
-        pass->cgam = std::make_shared<llvm::CGSCCAnalysisManager>();
-        pass->mam = std::make_shared<llvm::ModuleAnalysisManager>();
-        pass->pic = std::make_shared<llvm::PassInstrumentationCallbacks>();
-        pass->si = std::make_shared<llvm::StandardInstrumentations>(
-            *context,
-#ifdef NDEBUG
-            true
-#else
-            false
-#endif
-        );
-
-        pass->si->registerCallbacks(*pass->pic, pass->mam.get());
-
-        //
-
-        pass->fpm->addPass(llvm::InstCombinePass());
-        pass->fpm->addPass(llvm::ReassociatePass());
-        pass->fpm->addPass(llvm::GVNPass());
-        pass->fpm->addPass(llvm::SimplifyCFGPass());
-        pass->fpm->addPass(llvm::DSEPass());
-        pass->fpm->addPass(llvm::DCEPass());
-        pass->fpm->addPass(llvm::ADCEPass());
-        pass->fpm->addPass(llvm::SCCPPass());
-        pass->fpm->addPass(llvm::CorrelatedValuePropagationPass());
-
-        pass->pb.registerModuleAnalyses(*pass->mam);
-        pass->pb.registerFunctionAnalyses(*pass->fam);
-        pass->pb.crossRegisterProxies(*pass->lam, *pass->fam, *pass->cgam, *pass->mam);
+        return std::unique_ptr<llvm::TargetMachine>(tm);
     }
 
     Module Target::create_module(const std::string module_name) const {
@@ -84,38 +123,280 @@ namespace neonc {
         llvm_module->setDataLayout(target_machine->createDataLayout());
         llvm_module->setTargetTriple(target_triple);
         llvm_module->setUwtable(llvm::UWTableKind::Default);
-        llvm_module->setFramePointer(llvm::FramePointerKind::All);
 
-        return Module(context, llvm_module, target_cpu, target_features);
+        if (opt_level == OptLevel::O0)
+            llvm_module->setFramePointer(llvm::FramePointerKind::All);
+
+        return Module(context, llvm_module, target_cpu, target_features, opt_level);
+    }
+
+    void Target::optimize(Module & module) const {
+        optimize(*module.module, *target_machine);
+    }
+
+    void Target::optimize(llvm::Module & module, llvm::TargetMachine & machine) const {
+        // fresh analysis managers every time, cached results must not outlive the module they describe,
+        // declared in this order so that they are destroyed in the reverse one
+        llvm::LoopAnalysisManager lam;
+        llvm::FunctionAnalysisManager fam;
+        llvm::CGSCCAnalysisManager cgam;
+        llvm::ModuleAnalysisManager mam;
+
+        // vectorizers as clang enables them, Oz gives them up for size
+        llvm::PipelineTuningOptions tuning;
+        tuning.LoopVectorization = opt_level == OptLevel::O2 || opt_level == OptLevel::O3 || opt_level == OptLevel::Os;
+        tuning.SLPVectorization = tuning.LoopVectorization;
+
+        // with the target machine the pipeline gets the target's cost model and its own passes
+        llvm::PassBuilder pb(&machine, tuning);
+
+        pb.registerModuleAnalyses(mam);
+        pb.registerCGSCCAnalyses(cgam);
+        pb.registerFunctionAnalyses(fam);
+        pb.registerLoopAnalyses(lam);
+        pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+        auto mpm = opt_level == OptLevel::O0
+            ? pb.buildO0DefaultPipeline(llvm::OptimizationLevel::O0)
+            : pb.buildPerModuleDefaultPipeline(pipeline_level(opt_level));
+
+        mpm.run(module, mam);
+    }
+
+    uint32_t Target::partition_count(const Module & module) const {
+        uint64_t instructions = 0;
+
+        for (auto & function : *module.module)
+            instructions += function.getInstructionCount();
+
+        return std::clamp<uint64_t>(instructions / PARTITION_INSTRUCTIONS, 1, MAX_PARTITIONS);
     }
 
-    void Target::optimize(Module & module) {
-        for (auto & iterator : module.functions) {
-            pass->fpm->run(
-                *std::get<0>(std::get<0>(iterator.second)),
-                *pass->fam
-            );
+    std::optional<std::vector<llvm::SmallVector<char, 0>>> Target::compile_objects(Module & module, const uint32_t threads) const {
+        const auto partitions = partition_count(module);
+
+        std::vector<llvm::SmallVector<char, 0>> objects(partitions);
+
+        if (partitions == 1) {
+            llvm::raw_svector_ostream stream(objects[0]);
+
+            optimize(*module.module, *target_machine);
+
+            if (!emit(*module.module, *target_machine, stream))
+                return std::nullopt;
+
+            return objects;
         }
+
+        // partitions travel to the workers as bitcode, every worker parses its own into a context of its own,
+        // locals referenced across partitions are promoted to hidden globals by the split
+        std::vector<llvm::SmallString<0>> bitcode;
+
+        llvm::SplitModule(*module.module, partitions, [&](std::unique_ptr<llvm::Module> part) {
+            llvm::raw_svector_ostream stream(bitcode.emplace_back());
+            llvm::WriteBitcodeToFile(*part, stream);
+        });
+
+        std::atomic<uint32_t> next = 0;
+        std::atomic<bool> failed = false;
+
+        const auto workers = std::min(partitions, threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+
+        parallel_for(workers, [&](const uint32_t) {
+            auto machine = create_target_machine();
+
+            for (uint32_t i; (i = next++) < partitions;) {
+                llvm::LLVMContext context;
+                auto part = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode[i].str(), "partition"), context);
+
+                if (!part) {
+                    llvm::errs() << "Could not load partition: " << llvm::toString(part.takeError());
+                    failed = true;
+
+                    continue;
+                }
+
+                llvm::raw_svector_ostream stream(objects[i]);
+
+                optimize(**part, *machine);
+
+                if (!emit(**part, *machine, stream))
+                    failed = true;
+            }
+        });
+
+        if (failed)
+            return std::nullopt;
+
+        return objects;
     }
 
-    void Target::module_to_object_file(Module & module, const std::string out) const {
-        std::error_code e;
-        llvm::raw_fd_ostream dest(out + ".o", e, llvm::sys::fs::OF_None);
+    bool Target::compile(Module & module, const std::string out, const uint32_t threads) const {
+        const auto objects = compile_objects(module, threads);
 
-        if (e) {
-            llvm::errs() << "Could not open file: " << e.message();
-            return;
+        if (!objects)
+            return false;
+
+        if (objects->size() == 1) {
+            std::error_code e;
+            llvm::raw_fd_ostream dest(out + ".o", e, llvm::sys::fs::OF_None);
+
+            if (e) {
+                llvm::errs() << "Could not open file: " << e.message();
+                return false;
+            }
+
+            dest << llvm::StringRef(objects->front().data(), objects->front().size());
+            dest.close();
+
+            if (dest.has_error()) {
+                llvm::errs() << "Could not write file: " << dest.error().message();
+                dest.clear_error();
+
+                return false;
+            }
+
+            return true;
         }
 
+        // members in partition order and without timestamps, the archive is the same byte for byte every time
+        const auto stem = std::filesystem::path(out).filename().string();
+
+        std::vector<std::string> names;
+        std::vector<llvm::NewArchiveMember> members;
+
+        for (uint32_t i = 0; i < objects->size(); i++)
+            names.push_back(stem + "." + std::to_string(i) + ".o");
+
+        for (uint32_t i = 0; i < objects->size(); i++)
+            members.emplace_back(llvm::MemoryBufferRef(llvm::StringRef((*objects)[i].data(), (*objects)[i].size()), names[i]));
+
+        const auto kind = target_machine->getTargetTriple().isOSDarwin() ? llvm::object::Archive::K_DARWIN : llvm::object::Archive::K_GNU;
+
+        if (auto error = llvm::writeArchive(out + ".a", members, llvm::SymtabWritingMode::NormalSymtab, kind, true, false)) {
+            llvm::errs() << "Could not write archive: " << llvm::toString(std::move(error));
+
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Target::link(Module & module, const std::string out, const uint32_t threads) const {
+        const auto objects = compile_objects(module, threads);
+
+        if (!objects)
+            return false;
+
+        std::vector<llvm::MemoryBufferRef> buffers;
+
+        for (uint32_t i = 0; i < objects->size(); i++)
+            buffers.emplace_back(llvm::StringRef((*objects)[i].data(), (*objects)[i].size()), "partition");
+
+        return link_executable(target_machine->getTargetTriple(), buffers, out);
+    }
+
+    bool Target::emit(llvm::Module & module, llvm::TargetMachine & machine, llvm::raw_pwrite_stream & out) const {
         llvm::legacy::PassManager pass;
         auto ft = llvm::CodeGenFileType::CGFT_ObjectFile;
 
-        if (target_machine->addPassesToEmitFile(pass, dest, nullptr, ft)) {
+        if (machine.addPassesToEmitFile(pass, out, nullptr, ft)) {
             llvm::errs() << "TargetMachine can't emit a file of this type";
-            return;
+            return false;
+        }
+
+        pass.run(module);
+
+        return true;
+    }
+
+    std::optional<int> Target::run(
+        Module & module,
+        const std::string program,
+        const std::vector<std::string> & arguments,
+        const std::function<void()> & started
+    ) const {
+        // the jit owns the context of everything it compiles, the module moves there as bitcode, like a partition
+        llvm::SmallString<0> bitcode;
+        llvm::raw_svector_ostream stream(bitcode);
+        llvm::WriteBitcodeToFile(*module.module, stream);
+
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto parsed = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode.str(), program), *context);
+
+        if (!parsed) {
+            llvm::errs() << "Could not load module: " << llvm::toString(parsed.takeError()) << "\n";
+            return std::nullopt;
+        }
+
+        if (!build_entry(**parsed))
+            return std::nullopt;
+
+        auto machine = llvm::orc::JITTargetMachineBuilder(target_machine->getTargetTriple());
+        machine.setCPU(target_cpu);
+        machine.setCodeGenOptLevel(codegen_level(opt_level));
+
+        auto jit = llvm::orc::LLLazyJITBuilder().setJITTargetMachineBuilder(std::move(machine)).create();
+
+        if (!jit) {
+            llvm::errs() << "Could not create jit: " << llvm::toString(jit.takeError()) << "\n";
+            return std::nullopt;
+        }
+
+        auto & dylib = (*jit)->getMainJITDylib();
+
+        // libc and whatever else the compiler itself is linked against
+        auto process = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess((*jit)->getDataLayout().getGlobalPrefix());
+
+        if (!process) {
+            llvm::errs() << "Could not load process symbols: " << llvm::toString(process.takeError()) << "\n";
+            return std::nullopt;
         }
 
-        pass.run(*module.module);
-        dest.flush();
+        dylib.addGenerator(std::move(*process));
+
+        llvm::orc::SymbolMap symbols;
+        symbols[(*jit)->mangleAndIntern(STARTED)] = llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(&notify_started), llvm::JITSymbolFlags::Exported);
+
+        if (auto error = dylib.define(llvm::orc::absoluteSymbols(std::move(symbols)))) {
+            llvm::errs() << "Could not define " << STARTED << ": " << llvm::toString(std::move(error)) << "\n";
+            return std::nullopt;
+        }
+
+        // every function is a partition of its own, called through a stub that compiles it on the first call,
+        // except for main, which comes with the entry so that it is compiled before the entry starts
+        (*jit)->setPartitionFunction([](llvm::orc::CompileOnDemandLayer::GlobalValueSet requested) {
+            for (auto value : llvm::orc::CompileOnDemandLayer::GlobalValueSet(requested))
+                if (value->getName() == ENTRY)
+                    requested.insert(value->getParent()->getFunction("main"));
+
+            return requested;
+        });
+
+        // partitions are optimized on their way to the compiler, the lazy jit compiles on the thread that calls,
+        // so the target machine of the target is never used by two threads at once
+        (*jit)->getIRTransformLayer().setTransform([this](llvm::orc::ThreadSafeModule part, llvm::orc::MaterializationResponsibility &) {
+            part.withModuleDo([this](llvm::Module & module) { optimize(module, *target_machine); });
+
+            return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(part));
+        });
+
+        if (auto error = (*jit)->addLazyIRModule(llvm::orc::ThreadSafeModule(std::move(*parsed), std::move(context)))) {
+            llvm::errs() << "Could not add module: " << llvm::toString(std::move(error)) << "\n";
+            return std::nullopt;
+        }
+
+        auto entry = (*jit)->lookup(ENTRY);
+
+        if (!entry) {
+            llvm::errs() << "Could not find " << ENTRY << ": " << llvm::toString(entry.takeError()) << "\n";
+            return std::nullopt;
+        }
+
+        started_callback = &started;
+        auto code = llvm::orc::runAsMain(entry->toPtr<int (*)(int, char **)>(), arguments, llvm::StringRef(program));
+        started_callback = nullptr;
+
+        return code;
     }
 }
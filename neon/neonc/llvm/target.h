@@ -1,22 +1,47 @@
 #pragma once
 
 #include <neonc.h>
-#include "pass.h"
 #include "module.h"
+#include "opt_level.h"
 
 namespace neonc {
     class Target {
     public:
-        Target();
+        explicit Target(const OptLevel opt_level = OptLevel::O0);
+
+        // a module is compiled in one partition per this many instructions, up to MAX_PARTITIONS
+        static constexpr uint64_t PARTITION_INSTRUCTIONS = 50'000;
+        static constexpr uint32_t MAX_PARTITIONS = 32;
 
         Module create_module(const std::string module_name) const;
 
-        void optimize(Module & module);
+        // the default pipeline of `opt_level` over the whole module
+        void optimize(Module & module) const;
 
-        void module_to_object_file(Module & module, const std::string out) const;
-    public:
-        std::shared_ptr<Pass> pass;
+        // optimizes `module` and writes it to `out`.o, a large module is split into partitions instead,
+        // each optimized and compiled on one of `threads` threads (0 is one per core), and written as the
+        // archive `out`.a, the module is consumed either way, false (after printing why) if nothing was written
+        bool compile(Module & module, const std::string out, const uint32_t threads = 0) const;
+
+        // compiles `module` like `compile` does and links the objects, straight from memory, into the executable `out`,
+        // false (after printing why) if it could not be linked
+        bool link(Module & module, const std::string out, const uint32_t threads = 0) const;
+
+        // compiles `module` lazily in process and runs its `main` with `arguments` after `program`, like the c runtime
+        // would, every function is compiled and optimized when it is called for the first time, `started` is called
+        // once `main` is compiled, right before its first instruction, nullopt (after printing why) if it cannot run
+        std::optional<int> run(
+            Module & module,
+            const std::string program,
+            const std::vector<std::string> & arguments,
+            const std::function<void()> & started
+        ) const;
+
+        // depends on the module alone, so the output is the same for any number of threads
+        uint32_t partition_count(const Module & module) const;
     private:
+        OptLevel opt_level;
+
         std::string target_features;
         std::string target_cpu;
 
@@ -24,5 +49,14 @@ namespace neonc {
         std::string target_triple;
         const llvm::Target * target;
         std::unique_ptr<llvm::TargetMachine> target_machine;
+
+        // a target machine is used by one thread at a time, every partition worker creates its own
+        std::unique_ptr<llvm::TargetMachine> create_target_machine() const;
+
+        // one object per partition, in partition order, nullopt (after printing why) if any of them failed
+        std::optional<std::vector<llvm::SmallVector<char, 0>>> compile_objects(Module & module, const uint32_t threads) const;
+
+        void optimize(llvm::Module & module, llvm::TargetMachine & machine) const;
+        bool emit(llvm::Module & module, llvm::TargetMachine & machine, llvm::raw_pwrite_stream & out) const;
     };
 }
@@ -2,12 +2,17 @@
 
 namespace neonc {
     void throw_parse_error(const Pack * pack, const char * message) {
-        auto tok = pack->get();
-        auto src = extract_from_file(pack->file_name, tok.position.line);
+        if (pack->speculative)
+            throw ParseAbort();
 
-        std::cout << ColorRed << BoldFont << "Error" << ColorCyan << " -> " << ColorReset << pack->file_name << "\n";
-        std::cout << ColorCyan << tok.position.line << " | " << ColorReset << src << "\n";
-        std::cout << ColorCyan << std::string(std::to_string(tok.position.line).length(), ' ') << " |";
+        auto tok = pack->token();
+
+        // running into the end of the file after an earlier error, e.g. an unclosed delimiter, is a follow up
+        if (tok.token == TokenId::ENDOFFILE && diagnostics().has_errors())
+            throw ParseAbort();
+
+        std::stringstream text;
+        text << message << ", found '";
 
         if (
             tok.value.empty()
@@ -16,23 +21,20 @@ namespace neonc {
             || tok.token == TokenId::TAB
             || tok.token == TokenId::ENDOFFILE
         ) {
-            std::cout << ColorRed << std::string(tok.position.column, ' ') << "^ " << message << ", found '" << tok.token << "'" << ColorReset << "\n" << std::endl;
+            text << tok.token << "'";
         } else {
-            std::cout << ColorRed << std::string(tok.position.column, ' ') << "^ " << message << ", found '" << tok.value << "'" << ColorReset << "\n" << std::endl;
+            text << tok.value << "'";
         }
 
-        exit(0);
-    }
+        diagnostics().error(tok.location, text.str());
 
-    void throw_parse_error_at_position(const Pack * pack, const Position position, const char * message) {
-        auto src = extract_from_file(pack->file_name, position.line);
-
-        std::cout << ColorRed << BoldFont << "Error" << ColorCyan << " -> " << ColorReset << pack->file_name << "\n";
-        std::cout << ColorCyan << position.line << " | " << ColorReset << src << "\n";
-        std::cout << ColorCyan << std::string(std::to_string(position.line).length(), ' ') << " |";
+        throw ParseAbort();
+    }
 
-        std::cout << ColorRed << std::string(position.column, ' ') << "^ " << message << ColorReset << "\n" << std::endl;
+    void throw_parse_error_at(const Pack * pack, const SourceLoc location, const char * message) {
+        if (pack->speculative)
+            throw ParseAbort();
 
-        exit(0);
+        diagnostics().error(location, message);
     }
 }
@@ -2,9 +2,16 @@
 
 #include "pack.h"
 #include "../util/clicolor.h"
-#include "../util/extract_from_file.h"
+#include "../source/diagnostics.h"
 
 namespace neonc {
+    // unwinds to the statement or item being parsed, which resynchronizes, a speculative pack
+    // does not report the error and is not resynchronized, its caller parses again sequentially
+    struct ParseAbort {};
+
+    // reports an error at the current token and throws ParseAbort
     void throw_parse_error(const Pack * pack, const char * message);
-    void throw_parse_error_at_position(const Pack * pack, const Position position, const char * message);
+
+    // reports an error at `location`, parsing carries on
+    void throw_parse_error_at(const Pack * pack, const SourceLoc location, const char * message);
 }
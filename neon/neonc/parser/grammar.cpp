@@ -1,38 +1,29 @@
 #include "grammar.h"
 
-#define CHECK_NEWLINE_OR_SEMICOLON if (!accept(pack, TokenId::NEWLINE, std::nullopt).has_value()) { \
+#define CHECK_NEWLINE_OR_SEMICOLON if (pack->newline_before()) { pack->skip_newline(); } else { \
     if (!accept(pack, TokenId::SEMICOLON, std::nullopt)) { throw_parse_error(pack, "expected new line or semicolon"); } }
 
-#define PRECEDENCE_SORT(ops) for (unsigned long int i = 2; i < nodes.size(); i += 2) { \
-    auto & left = nodes[i - 2]; std::shared_ptr<Operator> op = std::dynamic_pointer_cast<Operator>(nodes[i - 1]); auto & right = nodes[i]; \
-    if (ops) { auto result = std::make_shared<Expression>(); \
-    result->nodes.push_back(left); result->nodes.push_back(op); result->nodes.push_back(right); \
-    nodes[i - 2] = result; nodes.erase(nodes.begin() + i - 1, nodes.begin() + i + 1); i -= 2; } }
-
 namespace neonc { 
-    const std::optional<Token> accept(Pack * pack, const TokenId to_find, const std::optional<TokenId> ignore, bool progress = true) {
-        for (std::size_t i = pack->index; i < std::size(pack->tokens); i++) {
-            Token tok = pack->tokens[i];
-
-            if (tok.token == to_find) {
-                if (progress)
-                    pack->index += i - pack->index + 1;
+    // newlines are a flag on the following token, so `ignore` can only be TokenId::NEWLINE,
+    // without it the token must be on the same line as the previous one
+    inline bool peek(const Pack * pack, const TokenId to_find, const std::optional<TokenId> ignore) {
+        return pack->get() == to_find && (ignore.has_value() || !pack->newline_before());
+    }
 
-                return tok;
-            }
+    // tokens are small views into the token buffer, accepting one never allocates
+    const std::optional<Token> accept(Pack * pack, const TokenId to_find, const std::optional<TokenId> ignore) {
+        if (!peek(pack, to_find, ignore))
+            return {};
 
-            if (ignore.has_value())
-                if (ignore.value() == tok.token)
-                    continue;
+        auto tok = pack->token();
 
-            return {};
-        }
+        pack->index++;
 
-        return {};
+        return tok;
     }
 
-    const std::optional<Token> expect(Pack * pack, const TokenId to_find, const std::optional<TokenId> ignore, const char * message, bool progress = true) {
-        auto result = accept(pack, to_find, ignore, progress);
+    const std::optional<Token> expect(Pack * pack, const TokenId to_find, const std::optional<TokenId> ignore, const char * message) {
+        auto result = accept(pack, to_find, ignore);
 
         if (!result.has_value()) {
             throw_parse_error(pack, message);
@@ -43,97 +34,136 @@ namespace neonc {
         return result;
     }
 
+    // skips the rest of a broken statement, up to the start of the next line, past a `;` or up to
+    // the `}` closing the body, always moving past at least one token
+    static void synchronize_statement(Pack * pack, const uint32_t start) {
+        if (pack->index == start)
+            pack->next();
+
+        uint32_t depth = 0;
+
+        while (!pack->is_at_end()) {
+            const auto token = pack->get();
+
+            if (depth == 0) {
+                if (token == TokenId::RBRACE || pack->newline_before())
+                    return;
+
+                if (token == TokenId::SEMICOLON) {
+                    pack->next();
+
+                    return;
+                }
+            }
+
+            if (token == TokenId::LBRACE)
+                depth++;
+            else if (token == TokenId::RBRACE)
+                depth--;
+
+            pack->next();
+        }
+    }
+
+    // skips to the next `fn` or `pub`, always moving past at least one token
+    static void synchronize_item(Pack * pack, const uint32_t start) {
+        if (pack->index == start)
+            pack->next();
+
+        while (!pack->is_at_end() && pack->get() != TokenId::FN && pack->get() != TokenId::PUB)
+            pack->next();
+    }
+
     inline static bool parse_body(Pack * pack, Node * node) {
-        if (pack->get().token == TokenId::ENDOFFILE) {
+        pack->skip_newline();
+
+        const auto start = pack->index;
+
+        if (pack->get() == TokenId::ENDOFFILE) {
             return false; 
-        } else if (accept(pack, TokenId::NEWLINE, {}, false) || accept(pack, TokenId::SEMICOLON, {}, false)) {
-            pack->next();
-        } else if (pack->get().token == TokenId::RBRACE) {
+        } else if (pack->get() == TokenId::RBRACE) {
             return false;
-        } else if (accept(pack, TokenId::VAR, TokenId::NEWLINE, false)) {
-            if (!parse_variable(pack, node)) return false;
-        } else if (accept(pack, TokenId::RET, TokenId::NEWLINE, false)) {
-            if (!parse_return(pack, node)) return false;
-        } else if (parse_standalone_expression(pack, node)) {
-            // nothing to do
-        } else {
-            throw_parse_error(pack, "unexpected");
-        } 
+        } else if (pack->get() == TokenId::FN || pack->get() == TokenId::PUB) {
+            return false; // the closing brace is missing, parse_function reports it
+        }
+
+        try {
+            if (peek(pack, TokenId::SEMICOLON, {})) {
+                pack->next();
+            } else if (peek(pack, TokenId::VAR, TokenId::NEWLINE)) {
+                if (!parse_variable(pack, node)) return false;
+            } else if (peek(pack, TokenId::RET, TokenId::NEWLINE)) {
+                if (!parse_return(pack, node)) return false;
+            } else if (!parse_standalone_expression(pack, node) || pack->index == start) {
+                throw_parse_error(pack, "unexpected");
+            }
+        } catch (const ParseAbort &) {
+            if (pack->speculative)
+                throw;
+
+            synchronize_statement(pack, start);
+        }
 
         return true;
     }
 
     inline static bool __parse(Pack * pack, Node * node) {
-        if (pack->get().token == TokenId::ENDOFFILE) {
-            return false;
-        } else if (accept(pack, TokenId::NEWLINE, {}, false) || accept(pack, TokenId::SEMICOLON, {}, false)) {
-            pack->next();
-        } else if (pack->get().token == TokenId::RBRACE) {
+        pack->skip_newline();
+
+        const auto start = pack->index;
+
+        if (pack->get() == TokenId::ENDOFFILE)
             return false;
-        } else if (
-            accept(pack, TokenId::FN, TokenId::NEWLINE, false)
-            || accept(pack, TokenId::PUB, TokenId::NEWLINE, false)
-        ) {
-            if (!parse_function(pack, node)) return false;
-        } else {
-            throw_parse_error(pack, "unexpected");
+
+        try {
+            if (peek(pack, TokenId::SEMICOLON, {})) {
+                pack->next();
+            } else if (
+                peek(pack, TokenId::FN, TokenId::NEWLINE)
+                || peek(pack, TokenId::PUB, TokenId::NEWLINE)
+            ) {
+                if (!parse_function(pack, node)) return false;
+            } else {
+                throw_parse_error(pack, "unexpected");
+            }
+        } catch (const ParseAbort &) {
+            if (pack->speculative)
+                throw;
+
+            synchronize_item(pack, start);
         }
 
         return true;
     }
 
-    void evaluate_expression(Node * node) {
-        std::vector<std::shared_ptr<Node>> & nodes = node->nodes;
-
-        PRECEDENCE_SORT(op->op == op::Operator::PERCENT || op->op == op::Operator::SLASH || op->op == op::Operator::ASTERISK);
-        PRECEDENCE_SORT(op->op == op::Operator::PLUS || op->op == op::Operator::MINUS);
-
-        PRECEDENCE_SORT(
-            op->op == op::Operator::EQUAL
-            || op->op == op::Operator::NOT_EQUAL
-            || op->op == op::Operator::GREATER_THAN
-            || op->op == op::Operator::LESS_THAN
-            || op->op == op::Operator::GREATER_THAN_OR_EQUAL
-            || op->op == op::Operator::LESS_THAN_OR_EQUAL
-        );
-
-        PRECEDENCE_SORT(op->op == op::Operator::NOT);
-        PRECEDENCE_SORT(op->op == op::Operator::B_LEFT_SHIFT || op->op == op::Operator::B_RIGHT_SHIFT);
-        PRECEDENCE_SORT(op->op == op::Operator::B_AND);
-        PRECEDENCE_SORT(op->op == op::Operator::B_XOR);
-        PRECEDENCE_SORT(op->op == op::Operator::B_OR);
-        PRECEDENCE_SORT(op->op == op::Operator::AND);
-        PRECEDENCE_SORT(op->op == op::Operator::OR);
-    }
-
     //
 
     const std::optional<Type> parse_type(Pack * pack) {
         auto _type = accept(pack, TokenId::IDENT, TokenId::NEWLINE);
 
-        std::string __type = "";
-        
-        if (_type) {
-            __type += _type->value;
-        } else {
+        if (!_type)
             return std::nullopt;
-        }
 
-        return Type(__type, _type->position);
+        return Type(_type->symbol, _type->location);
     }
 
     bool parse_number(Pack * pack, Node * node) {
-        auto neg = accept(pack, TokenId::MINUS, std::nullopt);
+        // a minus directly in front of a literal is part of it, so that e.g. -128 fits an i8
+        const bool neg = peek(pack, TokenId::MINUS, std::nullopt)
+            && (pack->get_next() == TokenId::NUMBER || pack->get_next() == TokenId::FLOATING_NUMBER);
+
+        if (neg)
+            pack->next();
 
         if (auto num = accept(pack, TokenId::NUMBER, TokenId::NEWLINE); num) {
-            node->add_node<Number>((neg ? "-" : "") + num->value, false, num->position);
+            node->add_node<Number>(*pack->arena, *pack->arena, pack->number(pack->index - 1), num->value, neg, num->location);
 
             return true;
         }
 
         if (auto fnum = accept(pack, TokenId::FLOATING_NUMBER, TokenId::NEWLINE); fnum) {
-            node->add_node<Number>((neg ? "-" : "") + fnum->value, true, fnum->position);
-            
+            node->add_node<Number>(*pack->arena, *pack->arena, pack->number(pack->index - 1), fnum->value, neg, fnum->location);
+
             return true;
         }
 
@@ -142,13 +172,13 @@ namespace neonc {
 
     bool parse_boolean(Pack * pack, Node * node) {
         if (auto _true = accept(pack, TokenId::TRUE, TokenId::NEWLINE); _true) {
-            node->add_node<Boolean>(true, _true->position);
+            node->add_node<Boolean>(*pack->arena, true, _true->location);
 
             return true;
         }
 
         if (auto _false = accept(pack, TokenId::FALSE, TokenId::NEWLINE); _false) {
-            node->add_node<Boolean>(false, _false->position);
+            node->add_node<Boolean>(*pack->arena, false, _false->location);
 
             return true;
         }
@@ -164,10 +194,10 @@ namespace neonc {
 
 
         if (accept(pack, TokenId::LPAREN, TokenId::NEWLINE)) {
-            auto call = node->add_node<Call>(ident->value, ident->position);
+            auto call = node->add_node<Call>(*pack->arena, ident->symbol, ident->location);
 
             while (true) {
-                if (!parse_expression(pack, call.get()))
+                if (!parse_expression(pack, call))
                     break;
 
                 if (!accept(pack, TokenId::COMMA, TokenId::NEWLINE))
@@ -176,7 +206,7 @@ namespace neonc {
 
             expect(pack, TokenId::RPAREN, TokenId::NEWLINE, "expected ')'");
         } else {
-            node->add_node<Identifier>(ident->value, ident->position);
+            node->add_node<Identifier>(*pack->arena, ident->symbol, ident->location);
         }
 
         return true;
@@ -184,9 +214,7 @@ namespace neonc {
 
     bool parse_string(Pack * pack, Node * node) {
         if (auto str = accept(pack, TokenId::STRING, TokenId::NEWLINE); str) {
-            std::string _str = str->value;
-
-            node->add_node<String>(str->value, str->position);
+            node->add_node<String>(*pack->arena, pack->arena->copy(str->value), str->location);
 
             return true;
         }
@@ -194,160 +222,254 @@ namespace neonc {
         return false;
     }
 
-    bool parse_operator(Pack * pack, Node * node) {
-        // +
-        if (accept(pack, TokenId::PLUS, TokenId::NEWLINE)) {
-            node->add_node<Operator>(op::Operator::PLUS);
-            return true;
+    namespace {
+        enum class Associativity : uint8_t { LEFT, RIGHT };
+
+        struct Binding {
+            uint8_t precedence; // higher binds tighter, 0 is not a binary operator
+            Associativity associativity;
+        };
+
+        // binding of every binary operator, indexed by op::Operator, the levels are the ones the language
+        // always had: arithmetic, then comparisons, then shifts and the bitwise operators, then the logical ones
+        constexpr Binding BINARY[] = {
+            { 10, Associativity::LEFT }, // PLUS
+            { 10, Associativity::LEFT }, // MINUS
+            { 11, Associativity::LEFT }, // SLASH
+            { 11, Associativity::LEFT }, // ASTERISK
+            { 11, Associativity::LEFT }, // PERCENT
+            { 9, Associativity::LEFT }, // EQUAL
+            { 9, Associativity::LEFT }, // NOT_EQUAL
+            { 9, Associativity::LEFT }, // GREATER_THAN
+            { 9, Associativity::LEFT }, // LESS_THAN
+            { 9, Associativity::LEFT }, // GREATER_THAN_OR_EQUAL
+            { 9, Associativity::LEFT }, // LESS_THAN_OR_EQUAL
+            { 0, Associativity::LEFT }, // NOT, prefix only
+            { 4, Associativity::LEFT }, // AND
+            { 7, Associativity::LEFT }, // B_AND
+            { 3, Associativity::LEFT }, // OR
+            { 5, Associativity::LEFT }, // B_OR
+            { 6, Associativity::LEFT }, // B_XOR
+            { 8, Associativity::LEFT }, // B_LEFT_SHIFT
+            { 8, Associativity::LEFT }, // B_RIGHT_SHIFT
+        };
+
+        // prefix operators bind tighter than any binary operator
+        constexpr uint8_t UNARY_PRECEDENCE = 12;
+
+        constexpr Binding binding(const op::Operator op) {
+            return BINARY[static_cast<uint8_t>(op)];
         }
-        // -
-        if (accept(pack, TokenId::MINUS, TokenId::NEWLINE)) {
-            node->add_node<Operator>(op::Operator::MINUS);
-            return true;
+
+        // operator waiting on the stack of parse_expression for its right operand
+        struct Pending {
+            enum class Kind : uint8_t { BINARY, UNARY, PAREN } kind;
+
+            op::Operator op;
+            uint8_t precedence;
+        };
+
+        void reduce(AstArena & arena, std::vector<Node *> & operands, const Pending & pending) {
+            auto expr = arena.make<Expression>();
+            auto operand = operands.back();
+
+            operands.pop_back();
+
+            if (pending.kind == Pending::Kind::BINARY) {
+                expr->add_node(arena, operands.back());
+                operands.pop_back();
+            }
+
+            expr->add_node<Operator>(arena, pending.op);
+            expr->add_node(arena, operand);
+
+            operands.push_back(expr);
         }
-        // /
-        if (accept(pack, TokenId::SLASH, TokenId::NEWLINE)) {
-            node->add_node<Operator>(op::Operator::SLASH);
-            return true;
+
+        // wraps a finished (sub)expression the same way a top level expression is wrapped
+        Expression * wrap(AstArena & arena, Node * node) {
+            auto expr = arena.make<Expression>();
+            expr->add_node(arena, node);
+
+            return expr;
         }
+    }
+
+    // binary operator at the cursor, consumed only if it is one
+    std::optional<op::Operator> parse_operator(Pack * pack) {
+        // +
+        if (accept(pack, TokenId::PLUS, TokenId::NEWLINE))
+            return op::Operator::PLUS;
+        // -
+        if (accept(pack, TokenId::MINUS, TokenId::NEWLINE))
+            return op::Operator::MINUS;
+        // /
+        if (accept(pack, TokenId::SLASH, TokenId::NEWLINE))
+            return op::Operator::SLASH;
         // *
-        if (accept(pack, TokenId::ASTERISK, TokenId::NEWLINE)) {
-            node->add_node<Operator>(op::Operator::ASTERISK);
-            return true;
-        }
+        if (accept(pack, TokenId::ASTERISK, TokenId::NEWLINE))
+            return op::Operator::ASTERISK;
         // %
-        if (accept(pack, TokenId::PERCENT, TokenId::NEWLINE)) {
-            node->add_node<Operator>(op::Operator::PERCENT);
-            return true;
-        }
+        if (accept(pack, TokenId::PERCENT, TokenId::NEWLINE))
+            return op::Operator::PERCENT;
         // ==
         if (accept(pack, TokenId::EQUALS, TokenId::NEWLINE)) {
             expect(pack, TokenId::EQUALS, {}, "expected '='");
 
-            node->add_node<Operator>(op::Operator::EQUAL);
-            return true;
+            return op::Operator::EQUAL;
         }
-        // !
-        // !=
-        if (accept(pack, TokenId::EXCLAMATION, TokenId::NEWLINE)) {
-            if (accept(pack, TokenId::EQUALS, {})) {
-                node->add_node<Operator>(op::Operator::NOT_EQUAL);
-                return true;
-            }
+        // !=, a lone `!` is a prefix operator and cannot follow an operand
+        if (peek(pack, TokenId::EXCLAMATION, TokenId::NEWLINE) && pack->get_next() == TokenId::EQUALS) {
+            pack->next();
+            pack->next();
 
-            node->add_node<Operator>(op::Operator::NOT);
-            return true;
+            return op::Operator::NOT_EQUAL;
         }
         // >
         // >=
         // >>
         if (accept(pack, TokenId::GREATER_THAN, TokenId::NEWLINE)) {
-            if (accept(pack, TokenId::EQUALS, {})) {
-                node->add_node<Operator>(op::Operator::GREATER_THAN_OR_EQUAL);
-                return true;
-            }
+            if (accept(pack, TokenId::EQUALS, {}))
+                return op::Operator::GREATER_THAN_OR_EQUAL;
 
-            if (accept(pack, TokenId::GREATER_THAN, {})) {
-                node->add_node<Operator>(op::Operator::B_RIGHT_SHIFT);
-                return true;
-            }
+            if (accept(pack, TokenId::GREATER_THAN, {}))
+                return op::Operator::B_RIGHT_SHIFT;
 
-            node->add_node<Operator>(op::Operator::GREATER_THAN);
-            return true;
+            return op::Operator::GREATER_THAN;
         }
         // <
         // <=
         // <<
         if (accept(pack, TokenId::LESS_THAN, TokenId::NEWLINE)) {
-            if (accept(pack, TokenId::EQUALS, {})) {
-                node->add_node<Operator>(op::Operator::LESS_THAN_OR_EQUAL);
-                return true;
-            }
+            if (accept(pack, TokenId::EQUALS, {}))
+                return op::Operator::LESS_THAN_OR_EQUAL;
 
-            if (accept(pack, TokenId::LESS_THAN, {})) {
-                node->add_node<Operator>(op::Operator::B_LEFT_SHIFT);
-                return true;
-            }
+            if (accept(pack, TokenId::LESS_THAN, {}))
+                return op::Operator::B_LEFT_SHIFT;
 
-            node->add_node<Operator>(op::Operator::LESS_THAN);
-            return true;
+            return op::Operator::LESS_THAN;
         }
         // &
         // &&
         if (accept(pack, TokenId::AND, TokenId::NEWLINE)) {
-            if (accept(pack, TokenId::AND, {})) {
-                node->add_node<Operator>(op::Operator::AND);
-                return true;
-            }
+            if (accept(pack, TokenId::AND, {}))
+                return op::Operator::AND;
 
-            node->add_node<Operator>(op::Operator::B_AND);
-            return true;
+            return op::Operator::B_AND;
         }
         // |
         // ||
         if (accept(pack, TokenId::OR, TokenId::NEWLINE)) {
-            if (accept(pack, TokenId::OR, {})) {
-                node->add_node<Operator>(op::Operator::OR);
-                return true;
-            }
+            if (accept(pack, TokenId::OR, {}))
+                return op::Operator::OR;
 
-            node->add_node<Operator>(op::Operator::B_OR);
-            return true;
+            return op::Operator::B_OR;
         }
         // ^
-        if (accept(pack, TokenId::CIRC, TokenId::NEWLINE)) {
-            node->add_node<Operator>(op::Operator::B_XOR);
-            return true;
-        }
+        if (accept(pack, TokenId::CIRC, TokenId::NEWLINE))
+            return op::Operator::B_XOR;
 
-        return false;
+        return std::nullopt;
     }
 
+    // precedence climbing over an explicit operator stack, the tree is built in one pass over the
+    // tokens and neither long operator chains nor deeply nested parentheses recurse, binary operators
+    // become Expression { lhs, op, rhs }, prefix operators Expression { op, operand }
     bool parse_expression(Pack * pack, Node * node) {
-        auto expr = std::make_shared<Expression>();
+        std::vector<Node *> operands;
+        std::vector<Pending> pending;
 
-    __parse_expr:
-        if (accept(pack, TokenId::LPAREN, TokenId::NEWLINE)) {
-            if (!parse_expression(pack, expr.get()))
-                return false;
+        const auto start = pack->index;
+        uint32_t open = 0; // parentheses on `pending`
 
-            expect(pack, TokenId::RPAREN, TokenId::NEWLINE, "expected ')'");
+        Expression primary; // the parse_* functions of operands append to a node, reused for every operand
+
+        // pops operators binding at least as tight as `precedence`, stops at an open parenthesis
+        auto reduce_to = [&](const uint8_t precedence) {
+            while (!pending.empty() && pending.back().kind != Pending::Kind::PAREN && pending.back().precedence >= precedence) {
+                reduce(*pack->arena, operands, pending.back());
+                pending.pop_back();
+            }
+        };
+
+        while (true) {
+            // prefix operators and open parentheses
+            while (true) {
+                if (accept(pack, TokenId::LPAREN, TokenId::NEWLINE)) {
+                    pending.push_back({ Pending::Kind::PAREN, op::Operator::PLUS, 0 });
+                    open++;
+                } else if (peek(pack, TokenId::EXCLAMATION, TokenId::NEWLINE)) {
+                    pack->next();
+                    pending.push_back({ Pending::Kind::UNARY, op::Operator::NOT, UNARY_PRECEDENCE });
+                } else if (
+                    peek(pack, TokenId::MINUS, TokenId::NEWLINE)
+                    && pack->get_next() != TokenId::NUMBER
+                    && pack->get_next() != TokenId::FLOATING_NUMBER
+                ) {
+                    pack->next();
+                    pending.push_back({ Pending::Kind::UNARY, op::Operator::MINUS, UNARY_PRECEDENCE });
+                } else {
+                    break;
+                }
+            }
+
+            if (!(
+                parse_boolean(pack, &primary)
+                || parse_number(pack, &primary)
+                || parse_ident(pack, &primary)
+                || parse_string(pack, &primary)
+            )) {
+                // nothing was consumed, the caller may try something else
+                if (pack->index == start)
+                    return false;
 
-            if (parse_operator(pack, expr.get()))
-                goto __parse_expr;
-            else {
-                evaluate_expression(expr.get());
+                throw_parse_error(pack, "expected expression");
+
+                return false;
+            }
 
-                node->add_node(expr);
+            operands.push_back(std::move(primary.nodes.back()));
+            primary.nodes.pop_back();
 
-                return true;
+            // closing parentheses, a ')' without an open one belongs to the caller
+            while (open > 0 && accept(pack, TokenId::RPAREN, TokenId::NEWLINE)) {
+                reduce_to(0);
+                pending.pop_back();
+                open--;
+
+                operands.back() = wrap(*pack->arena, operands.back());
             }
+
+            const auto op = parse_operator(pack);
+
+            if (!op)
+                break;
+
+            const auto [precedence, associativity] = binding(*op);
+
+            reduce_to(associativity == Associativity::LEFT ? precedence : precedence + 1);
+
+            pending.push_back({ Pending::Kind::BINARY, *op, precedence });
         }
 
-        if (!(
-            parse_boolean(pack, expr.get())
-            || parse_number(pack, expr.get())
-            || parse_ident(pack, expr.get())
-            || parse_string(pack, expr.get())
-        )) {
+        if (open > 0) {
+            throw_parse_error(pack, "expected ')'");
+
             return false;
         }
 
-        if (parse_operator(pack, expr.get()))
-            goto __parse_expr;
+        reduce_to(0);
 
-        evaluate_expression(expr.get());
-
-        node->add_node(expr);
+        node->add_node(*pack->arena, wrap(*pack->arena, operands.back()));
 
         return true;
     }
 
     bool parse_standalone_expression(Pack * pack, Node * node) {
-        auto var = std::make_shared<Variable>();
+        auto var = pack->arena->make<Variable>();
 
-        if (parse_expression(pack, var.get()))
-            node->add_node(var);
+        if (parse_expression(pack, var))
+            node->add_node(*pack->arena, var);
 
         CHECK_NEWLINE_OR_SEMICOLON;
 
@@ -355,9 +477,9 @@ namespace neonc {
     }
 
     bool parse_return(Pack * pack, Node * node) {
-        auto ret = node->add_node<Return>(accept(pack, TokenId::RET, TokenId::NEWLINE)->position);
+        auto ret = node->add_node<Return>(*pack->arena, accept(pack, TokenId::RET, TokenId::NEWLINE)->location);
 
-        parse_expression(pack, ret.get());
+        parse_expression(pack, ret);
 
         CHECK_NEWLINE_OR_SEMICOLON;
 
@@ -377,10 +499,10 @@ namespace neonc {
                 return false;
             }
 
-            auto var = node->add_node<Variable>(ident->value, _type, _var->position);
+            auto var = node->add_node<Variable>(*pack->arena, ident->symbol, _type, _var->location);
 
             if (accept(pack, TokenId::EQUALS, TokenId::NEWLINE)) {
-                if (!parse_expression(pack, var.get())) {
+                if (!parse_expression(pack, var)) {
                     throw_parse_error(pack, "expected expression");
 
                     return false;
@@ -389,9 +511,9 @@ namespace neonc {
         } else {
             expect(pack, TokenId::EQUALS, TokenId::NEWLINE, "expected ':' or '='");
 
-            auto var = node->add_node<Variable>(ident->value, std::nullopt, _var->position);
+            auto var = node->add_node<Variable>(*pack->arena, ident->symbol, std::nullopt, _var->location);
 
-            if (!parse_expression(pack, var.get())) {
+            if (!parse_expression(pack, var)) {
                 throw_parse_error(pack, "expected expression");
 
                 return false;
@@ -403,7 +525,7 @@ namespace neonc {
         return true;
     }
 
-    bool parse_function_arguments(Pack * pack, std::shared_ptr<Function> func) {
+    bool parse_function_arguments(Pack * pack, Function * func) {
         std::vector<Argument> args;
 
         while (true) {
@@ -412,7 +534,7 @@ namespace neonc {
             if (!ident)
                 break;
 
-            if (accept(pack, TokenId::COLON, TokenId::NEWLINE, "expected ':'")) {
+            if (accept(pack, TokenId::COLON, TokenId::NEWLINE)) {
                 if (accept(pack, TokenId::DOT, TokenId::NEWLINE)) {
                     expect(pack, TokenId::DOT, TokenId::NEWLINE, "expected '...'");
                     expect(pack, TokenId::DOT, TokenId::NEWLINE, "expected '...'");
@@ -425,7 +547,7 @@ namespace neonc {
                         return false;
                     }
     
-                    auto vaarg = Argument(ident->value, _type, _type->position);
+                    auto vaarg = Argument(ident->symbol, _type, _type->location);
                     vaarg.set_variadic(true);
                     args.push_back(vaarg);
 
@@ -442,9 +564,9 @@ namespace neonc {
                     return false;
                 }
 
-                args.push_back(Argument(ident->value, _type, ident->position));
+                args.push_back(Argument(ident->symbol, _type, ident->location));
             } else {
-                args.push_back(Argument(ident->value, std::nullopt, ident->position));
+                args.push_back(Argument(ident->symbol, std::nullopt, ident->location));
             }
 
             if (!accept(pack, TokenId::COMMA, TokenId::NEWLINE))
@@ -454,7 +576,7 @@ namespace neonc {
         for (int32_t i = args.size(); i >= 0; i--) { // propagate types from right to left
             if (i == int32_t(args.size()) - 1 && !args[i].get_type().has_value()) {
             __no_type:
-                throw_parse_error_at_position(pack, args[i].get_position().value(), "argument has no type");
+                throw_parse_error_at(pack, args[i].get_location(), "argument has no type");
             } else if (i < int32_t(args.size())) {
                 if (args[i + 1].get_variadic() && !args[i].get_type()) {
                     goto __no_type;
@@ -466,7 +588,7 @@ namespace neonc {
             }
         }
 
-        func->add_arguments(args);
+        func->set_arguments(*pack->arena, args);
 
         return true;
     }
@@ -476,7 +598,7 @@ namespace neonc {
         auto fntok = expect(pack, TokenId::FN, TokenId::NEWLINE, "expected 'fn'");
         auto ident = expect(pack, TokenId::IDENT, TokenId::NEWLINE, "expected identifier");
  
-        auto func = node->add_node<Function>(ident->value, fntok->position);
+        auto func = node->add_node<Function>(*pack->arena, ident->symbol, fntok->location);
 
         if (pub)
             func->set_public(true);
@@ -498,16 +620,20 @@ namespace neonc {
 
         expect(pack, TokenId::LBRACE, TokenId::NEWLINE, "expected '{'");
 
-        while (parse_body(pack, func.get()));
+        while (parse_body(pack, func));
 
         expect(pack, TokenId::RBRACE, TokenId::NEWLINE, "expected '}'");
 
         return true;
     }
  
-    void parse(Pack * pack, std::shared_ptr<Node> node) {
+    void parse_items(Pack * pack, Node * node, const uint32_t end) {
+        while (pack->index < end && __parse(pack, node));
+    }
+
+    void parse(Pack * pack, Node * node) {
         while (true) {
-            if (!__parse(pack, node.get())) {
+            if (!__parse(pack, node)) {
                 break;
             }
         }
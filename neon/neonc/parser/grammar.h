@@ -17,21 +17,27 @@
 #include "../ast/return.h"
 
 namespace neonc {
-    const std::optional<Type> parse_type(Pack * pack);
+    // consumes the current token if it is `to_find`, a token after a newline only with `ignore` set to
+    // TokenId::NEWLINE, `expect` reports `message` otherwise, neither allocates
+    const std::optional<Token> accept(Pack * pack, const TokenId to_find, const std::optional<TokenId> ignore);
+    const std::optional<Token> expect(Pack * pack, const TokenId to_find, const std::optional<TokenId> ignore, const char * message);
 
-    void evaluate_expression(Node * node);
+    const std::optional<Type> parse_type(Pack * pack);
 
     bool parse_ident(Pack * pack, Node * node);
     bool parse_string(Pack * pack, Node * node);
     bool parse_boolean(Pack * pack, Node * node);
     bool parse_number(Pack * pack, Node * node);
-    bool parse_operator(Pack * pack, Node * node);
+    std::optional<op::Operator> parse_operator(Pack * pack);
     bool parse_expression(Pack * pack, Node * node);
     bool parse_standalone_expression(Pack * pack, Node * node);
     bool parse_return(Pack * pack, Node * node);
     bool parse_variable(Pack * pack, Node * node);
-    bool parse_function_arguments(Pack * pack, std::shared_ptr<Function> node);
+    bool parse_function_arguments(Pack * pack, Function * node);
     bool parse_function(Pack * pack, Node * node);
 
-    void parse(Pack * pack, std::shared_ptr<Node> node);
+    void parse(Pack * pack, Node * node);
+
+    // parses top level items until the cursor reaches token `end`
+    void parse_items(Pack * pack, Node * node, const uint32_t end);
 }
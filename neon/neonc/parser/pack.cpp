@@ -2,29 +2,50 @@
 #include <vector>
 
 namespace neonc {
-    Token Pack::get() const {
-        return tokens[index];
+    TokenId Pack::get() const {
+        return tokens->kind(slot(index));
     }
 
-    Token Pack::get_next() const {
-        return tokens[index + 1];
+    TokenId Pack::get_next() const {
+        return tokens->kind(slot(index + 1));
     }
 
-    Token Pack::get_previous() const {
-        return tokens[index - 1];
+    TokenId Pack::get_previous() const {
+        return tokens->kind(slot(index - 1));
     }
 
-    Token Pack::get_offset(const int64_t offset) const {
-        return tokens[index + offset];
+    TokenId Pack::get_offset(const int64_t offset) const {
+        return tokens->kind(slot(index + offset));
+    }
+
+    Token Pack::token() const {
+        return tokens->get(slot(index));
+    }
+
+    NumberLiteral Pack::number(const uint32_t index) const {
+        const auto at = slot(index);
+
+        if (tokens->kind(at) == TokenId::FLOATING_NUMBER)
+            return tokens->floating(at);
+
+        return tokens->integer(at);
+    }
+
+    bool Pack::newline_before() const {
+        return tokens->newline_before(slot(index)) && skipped_newline != index;
+    }
+
+    void Pack::skip_newline() {
+        skipped_newline = index;
     }
 
     bool Pack::is_at_end() const {
-        return index >= tokens.size() - 1;
+        return get() == TokenId::ENDOFFILE;
     }
 
-    Token Pack::next() {
+    TokenId Pack::next() {
         index++;
 
-        return tokens[index];
+        return tokens->kind(slot(index));
     }
 }
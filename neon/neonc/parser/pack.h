@@ -1,21 +1,45 @@
 #pragma once
 
-#include "../lexer/token.h"
+#include "../lexer/lexer.h"
+#include "../lexer/token_buffer.h"
+#include "../ast/arena.h"
 #include <neonc.h>
 
 namespace neonc {
+    // cursor of the parser, reads either a fully lexed buffer or pulls from a token stream
     struct Pack {
-        Pack(const std::string file_name, std::vector<Token> tokens) : file_name(file_name), tokens(tokens) {}
+        Pack(const TokenBuffer & tokens) : file(tokens.get_file()), tokens(&tokens) {}
+        Pack(TokenStream & stream) : file(stream.get_file()), tokens(&stream.buffer()), stream(&stream) {}
 
-        const std::string file_name;
-        Token get() const;
-        Token get_next() const;
-        Token get_previous() const;
-        Token get_offset(const int64_t offset) const;
+        const FileId file;
+        TokenId get() const;
+        TokenId get_next() const;
+        TokenId get_previous() const;
+        TokenId get_offset(const int64_t offset) const;
+        Token token() const;
+        NumberLiteral number(const uint32_t index) const;
+        bool newline_before() const;
+        void skip_newline();
         bool is_at_end() const;
-        Token next();
+        TokenId next();
 
         uint32_t index = 0;
-        const std::vector<Token> tokens;
+
+        // every node of the tree being parsed is allocated here
+        AstArena * arena = nullptr;
+
+        // parse errors throw ParseAbort instead of being reported
+        bool speculative = false;
+    private:
+        const TokenBuffer * tokens;
+        TokenStream * stream = nullptr;
+
+        // index of the token whose preceding newline was already consumed by the grammar
+        uint32_t skipped_newline = std::numeric_limits<uint32_t>::max();
+
+        // position of token `index` in `tokens`, lexing it first when streaming
+        uint32_t slot(const uint32_t index) const {
+            return stream ? stream->fetch(index) : index;
+        }
     };
 }
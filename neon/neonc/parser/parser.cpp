@@ -1,16 +1,135 @@
 #include "parser.h"
+#include "../util/parallel.h"
 
 namespace neonc {
-    const AbstractSyntaxTree Parser::parse_ast(const std::string absolute_file_path, std::vector<Token> tokens) const {
-        auto pack = Pack(absolute_file_path, tokens);
+    namespace {
+        // first token of every top level item, an item starts at `fn` or `pub fn` outside of any braces
+        std::vector<uint32_t> split_items(const TokenBuffer & tokens) {
+            std::vector<uint32_t> items;
+            uint32_t depth = 0;
 
-        auto ast = AbstractSyntaxTree(
-            std::make_shared<Root>(get_root() + "/" + std::filesystem::path(absolute_file_path).filename().string()),
-            absolute_file_path
-        );
+            for (uint32_t i = 0; i < tokens.size(); i++) {
+                switch (tokens.kind(i)) {
+                case TokenId::LBRACE: depth++; break;
+                case TokenId::RBRACE: if (depth > 0) depth--; break;
+                case TokenId::PUB: if (depth == 0) items.push_back(i); break;
+                case TokenId::FN: if (depth == 0 && (i == 0 || tokens.kind(i - 1) != TokenId::PUB)) items.push_back(i); break;
+                default: break;
+                }
+            }
 
-        parse(&pack, ast.get_root_ptr());
+            return items;
+        }
+    }
+
+    uint32_t Parser::thread_count(const uint32_t tokens) const {
+        if (tokens < parallel_threshold)
+            return 1;
+
+        return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    Root * Parser::make_root(AstArena & arena, const FileId file) const {
+        auto & absolute_file_path = source_manager().path(file);
+
+        return arena.make<Root>(arena, get_root() + "/" + std::filesystem::path(absolute_file_path).filename().string());
+    }
+
+    const AbstractSyntaxTree Parser::parse_ast(const TokenBuffer & tokens) const {
+        if (const auto count = thread_count(tokens.size()); count > 1)
+            if (auto ast = parse_parallel(tokens, count); ast)
+                return std::move(*ast);
+
+        auto pack = Pack(tokens);
+
+        return parse_ast(pack);
+    }
+
+    const AbstractSyntaxTree Parser::parse_ast(TokenStream & stream) const {
+        auto pack = Pack(stream);
+
+        return parse_ast(pack);
+    }
+
+    const AbstractSyntaxTree Parser::parse_ast(Pack & pack) const {
+        std::vector<std::unique_ptr<AstArena>> arenas;
+        arenas.push_back(std::make_unique<AstArena>());
+
+        auto root = make_root(*arenas.front(), pack.file);
+
+        pack.arena = arenas.front().get();
+
+        parse(&pack, root);
+
+        pack.arena = nullptr;
+
+        return AbstractSyntaxTree(std::move(arenas), root);
+    }
+
+    // top level items do not depend on each other, so runs of them are parsed on their own threads into
+    // their own arenas and appended to the root in source order, any parse error or a run that does not
+    // end exactly where the next one starts gives up and the caller parses sequentially, which reports
+    // the first error just like it always did
+    std::optional<AbstractSyntaxTree> Parser::parse_parallel(const TokenBuffer & tokens, const uint32_t count) const {
+        // an edited source is made contiguous here, token values read it from every thread below
+        source_manager().buffer(tokens.get_file());
+
+        const auto items = split_items(tokens);
+        const uint32_t eof = tokens.size() - 1;
+
+        // runs of about the same number of tokens, the first one also takes whatever precedes the first item
+        std::vector<uint32_t> bounds = { 0 };
+
+        for (uint32_t i = 1; i < count; i++) {
+            auto item = std::lower_bound(items.begin(), items.end(), uint64_t(eof) * i / count);
+
+            bounds.push_back(item == items.end() ? eof : std::max(*item, bounds.back()));
+        }
+
+        bounds.push_back(eof);
+
+        struct Run {
+            std::unique_ptr<AstArena> arena = std::make_unique<AstArena>();
+            Expression items; // scratch parent, only its children are kept
+            bool failed = false;
+        };
+
+        std::vector<Run> runs(count);
+
+        parallel_for(count, [&](const uint32_t i) {
+            auto & run = runs[i];
+            auto pack = Pack(tokens);
+
+            pack.index = bounds[i];
+            pack.arena = run.arena.get();
+            pack.speculative = true;
+
+            try {
+                parse_items(&pack, &run.items, bounds[i + 1]);
+            } catch (const ParseAbort &) {
+                run.failed = true;
+            }
+
+            if (pack.index != bounds[i + 1])
+                run.failed = true;
+        });
+
+        for (auto & run : runs)
+            if (run.failed)
+                return std::nullopt;
+
+        std::vector<std::unique_ptr<AstArena>> arenas;
+        arenas.push_back(std::make_unique<AstArena>());
+
+        auto root = make_root(*arenas.front(), tokens.get_file());
+
+        for (auto & run : runs) {
+            for (auto node : run.items.nodes)
+                root->add_node(*arenas.front(), node);
+
+            arenas.push_back(std::move(run.arena));
+        }
 
-        return ast;
+        return AbstractSyntaxTree(std::move(arenas), root);
     }
 }
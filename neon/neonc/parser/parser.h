@@ -1,6 +1,6 @@
 #pragma once
 
-#include "../lexer/token.h"
+#include "../lexer/token_buffer.h"
 #include "pack.h"
 #include "../ast/ast.h"
 #include "../ast/root.h"
@@ -11,9 +11,27 @@
 namespace neonc {
     class Parser {
     public:
-        Parser() = default;
+        // token buffers of at least this many tokens are parsed on several threads, a run of top level items each
+        static constexpr uint32_t PARALLEL_THRESHOLD = 256 * 1024;
 
-        const AbstractSyntaxTree parse_ast(const std::string absolute_file_path, std::vector<Token> tokens) const;
+        // `threads` of 0 uses every hardware thread, 1 keeps parsing sequential
+        Parser(const uint32_t threads = 0, const uint32_t parallel_threshold = PARALLEL_THRESHOLD)
+            : threads(threads), parallel_threshold(parallel_threshold) {}
+
+        const AbstractSyntaxTree parse_ast(const TokenBuffer & tokens) const;
+
+        // parses while pulling tokens from `stream`, lexing overlaps with parsing
+        const AbstractSyntaxTree parse_ast(TokenStream & stream) const;
     private:
+        const uint32_t threads;
+        const uint32_t parallel_threshold;
+
+        uint32_t thread_count(const uint32_t tokens) const;
+
+        Root * make_root(AstArena & arena, const FileId file) const;
+
+        const AbstractSyntaxTree parse_ast(Pack & pack) const;
+
+        std::optional<AbstractSyntaxTree> parse_parallel(const TokenBuffer & tokens, const uint32_t count) const;
     };
 }
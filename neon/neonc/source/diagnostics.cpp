@@ -0,0 +1,70 @@
+#include "diagnostics.h"
+
+#include "source_manager.h"
+#include "../util/clicolor.h"
+
+namespace neonc {
+    void Diagnostics::error(const SourceLoc location, std::string message) {
+        if (!location.valid()) {
+            std::cerr << "ICE: diagnostic without a location: " << message << std::endl;
+            exit(0);
+        }
+
+        std::lock_guard lock(mutex);
+
+        errors.push_back({ location, std::move(message) });
+    }
+
+    bool Diagnostics::has_errors() const {
+        std::lock_guard lock(mutex);
+
+        return !errors.empty();
+    }
+
+    uint32_t Diagnostics::error_count() const {
+        std::lock_guard lock(mutex);
+
+        return errors.size();
+    }
+
+    void Diagnostics::flush(std::ostream & out) {
+        std::lock_guard lock(mutex);
+
+        // the lexer runs ahead of the parser, so errors are not reported in source order
+        std::stable_sort(errors.begin(), errors.end(), [](const Diagnostic & a, const Diagnostic & b) {
+            return a.location.raw < b.location.raw;
+        });
+
+        for (uint32_t i = 0; i < errors.size(); i++) {
+            auto & error = errors[i];
+
+            if (i > 0 && errors[i - 1].location.raw == error.location.raw)
+                continue;
+
+            const auto file = source_manager().file(error.location);
+            const auto position = source_manager().position(error.location);
+
+            auto src = source_manager().line(file, position.line);
+
+            out << ColorRed << BoldFont << "Error" << ColorCyan << " -> " << ColorReset << source_manager().path(file) << "\n";
+            out << ColorCyan << position.line << " | " << ColorReset << src << "\n";
+            out << ColorCyan << std::string(std::to_string(position.line).length(), ' ') << " |";
+
+            out << ColorRed << std::string(position.column, ' ') << "^ " << error.message << ColorReset << "\n" << std::endl;
+        }
+
+        errors.clear();
+    }
+
+    void Diagnostics::clear() {
+        std::lock_guard lock(mutex);
+
+        errors.clear();
+    }
+
+    Diagnostics & diagnostics() {
+        static Diagnostics instance;
+
+        return instance;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <neonc.h>
+#include "../types/source_loc.h"
+
+namespace neonc {
+    struct Diagnostic {
+        SourceLoc location;
+        std::string message;
+    };
+
+    // errors of a compilation are collected here instead of ending the process on the first one,
+    // reporting is thread safe
+    class Diagnostics {
+    public:
+        void error(const SourceLoc location, std::string message);
+
+        bool has_errors() const;
+        uint32_t error_count() const;
+
+        // prints every collected error ordered by location and forgets them, an error at the same
+        // location as the one before it is a follow up and is left out
+        void flush(std::ostream & out = std::cout);
+
+        void clear();
+    private:
+        mutable std::mutex mutex;
+
+        std::vector<Diagnostic> errors;
+    };
+
+    // compiler wide diagnostics
+    Diagnostics & diagnostics();
+}
@@ -0,0 +1,204 @@
+#include "source_manager.h"
+
+#include "../lexer/scan.h"
+
+namespace neonc {
+    std::optional<FileId> SourceManager::load(const std::string & path) {
+        // no null terminator is required, which lets llvm mmap the file instead of copying it
+        auto buffer = llvm::MemoryBuffer::getFile(path, false, false);
+
+        if (!buffer) {
+            std::cerr << "Error: " << buffer.getError().message() << std::endl;
+            std::cerr << "File Path: " << path << std::endl;
+
+            return std::nullopt;
+        }
+
+        return insert(path, std::move(*buffer));
+    }
+
+    FileId SourceManager::add(const std::string & name, const std::string_view contents) {
+        return insert(name, llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef(contents.data(), contents.size()), name));
+    }
+
+    FileId SourceManager::insert(const std::string & path, std::unique_ptr<llvm::MemoryBuffer> buffer) {
+        if (buffer->getBufferSize() >= std::numeric_limits<uint32_t>::max() - next_base) {
+            std::cerr << "Error: source files are limited to 4 GB in total" << std::endl;
+            std::cerr << "File Path: " << path << std::endl;
+
+            exit(1);
+        }
+
+        const FileId id = files.size();
+        const uint32_t span = buffer->getBufferSize() + 1;
+
+        bases.push_back(next_base);
+        spans.push_back({ next_base, id });
+        next_base += span;
+
+        std::vector<uint32_t> starts;
+        starts.reserve(buffer->getBufferSize() / 32 + 1);
+        starts.push_back(0);
+
+        scan().lines(buffer->getBufferStart(), 0, buffer->getBufferSize(), starts);
+
+        GapArray<uint32_t> line_starts;
+        line_starts.insert(starts.begin(), starts.end());
+
+        files.push_back({ path, std::move(buffer), {}, std::move(line_starts), span });
+
+        return id;
+    }
+
+    bool SourceManager::rebase(const FileId file, const uint32_t size) {
+        if (size >= std::numeric_limits<uint32_t>::max() - next_base)
+            return false;
+
+        // twice what is needed, a file that grows a keystroke at a time moves once every time it doubles
+        const uint32_t span = std::min<uint64_t>(uint64_t(size) * 2 + 1, std::numeric_limits<uint32_t>::max() - next_base);
+
+        spans.erase(std::find_if(spans.begin(), spans.end(), [&](const Span & span) { return span.file == file; }));
+        spans.push_back({ next_base, file });
+
+        bases[file] = next_base;
+        files[file].span = span;
+        next_base += span;
+
+        return true;
+    }
+
+    bool SourceManager::edit(const FileId id, const uint32_t offset, const uint32_t length, const std::string_view text) {
+        auto & file = files[id];
+
+        const uint32_t size = file.size();
+
+        if (offset > size || length > size - offset)
+            return false;
+
+        const uint64_t edited = uint64_t(size) - length + text.size();
+
+        if (edited >= file.span && (edited >= std::numeric_limits<uint32_t>::max() || !rebase(id, edited)))
+            return false;
+
+        // the first edit copies the file out of its buffer, every later one edits it in place, the holes start
+        // out as large as the file so that it takes a long time of typing until they grow again
+        if (file.buffer) {
+            file.text.insert(file.buffer->getBufferStart(), file.buffer->getBufferEnd());
+            file.text.reserve_gap(size);
+            file.line_starts.reserve_gap(file.line_starts.size());
+            file.buffer.reset();
+        }
+
+        // lines starting in the replaced bytes go, the ones in front stay and the ones behind are counted
+        // from the end, which moves them along with it
+        const auto first = file.upper_line(offset);
+        const auto last = file.upper_line(offset + length);
+
+        file.line_starts.move_gap(first, [&](const uint32_t start) { return size - start; });
+        file.line_starts.erase(last - first);
+
+        file.text.move_gap(offset);
+        file.text.erase(length);
+        file.text.insert(text.begin(), text.end());
+
+        std::vector<uint32_t> starts;
+        scan().lines(text.data(), 0, text.size(), starts);
+
+        for (const auto start : starts)
+            file.line_starts.insert(offset + start);
+
+        return true;
+    }
+
+    uint32_t SourceManager::File::upper_line(const uint32_t offset) const {
+        return partition_near(line_starts.size(), line_starts.gap(), [&](const uint32_t line) {
+            return line_start(line) <= offset;
+        });
+    }
+
+    const std::string & SourceManager::path(const FileId file) const {
+        return files[file].path;
+    }
+
+    std::string_view SourceManager::buffer(const FileId file) const {
+        auto & f = files[file];
+
+        if (f.buffer)
+            return std::string_view(f.buffer->getBufferStart(), f.buffer->getBufferSize());
+
+        return std::string_view(f.text.contiguous(), f.text.size());
+    }
+
+    uint32_t SourceManager::size(const FileId file) const {
+        return files[file].size();
+    }
+
+    void SourceManager::copy(const FileId file, const uint32_t begin, const uint32_t end, std::string & out) const {
+        auto & f = files[file];
+        const auto at = out.size();
+
+        out.resize(at + end - begin);
+
+        if (f.buffer) {
+            std::memcpy(out.data() + at, f.buffer->getBufferStart() + begin, end - begin);
+        } else {
+            f.text.copy(begin, end, out.data() + at);
+        }
+    }
+
+    Position SourceManager::position(const FileId file, const uint32_t offset) const {
+        auto & f = files[file];
+
+        const auto line = f.upper_line(offset);
+
+        return Position(line, offset - f.line_start(line - 1) + 1);
+    }
+
+    Position SourceManager::position(const SourceLoc location) const {
+        return position(file(location), offset(location));
+    }
+
+    SourceLoc SourceManager::location(const FileId file, const uint32_t offset) const {
+        return SourceLoc { bases[file] + offset };
+    }
+
+    FileId SourceManager::file(const SourceLoc location) const {
+        if (!location.valid()) {
+            std::cerr << "ICE: cannot resolve an invalid source location" << std::endl;
+            exit(0);
+        }
+
+        const auto span = std::upper_bound(spans.begin(), spans.end(), location.raw, [](const uint32_t raw, const Span & span) {
+            return raw < span.base;
+        });
+
+        return std::prev(span)->file;
+    }
+
+    uint32_t SourceManager::offset(const SourceLoc location) const {
+        return location.raw - bases[file(location)];
+    }
+
+    std::string_view SourceManager::line(const FileId file, const uint64_t line) const {
+        auto & f = files[file];
+
+        if (line == 0 || line > f.line_starts.size())
+            return {};
+
+        const auto source = buffer(file);
+        const uint32_t start = f.line_start(line - 1);
+        const uint32_t end = line < f.line_starts.size() ? f.line_start(line) - 1 : source.size();
+
+        return source.substr(start, end - start);
+    }
+
+    uint32_t SourceManager::line_count(const FileId file) const {
+        return files[file].line_starts.size();
+    }
+
+    SourceManager & source_manager() {
+        static SourceManager instance;
+
+        return instance;
+    }
+}
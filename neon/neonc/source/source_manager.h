@@ -0,0 +1,100 @@
+#pragma once
+
+#include <neonc.h>
+#include "../types/position.h"
+#include "../types/source_loc.h"
+#include "../util/gap_array.h"
+
+namespace neonc {
+    using FileId = uint32_t;
+
+    // owns every source buffer of a compilation, files are mapped once and indexed by line
+    // so that diagnostics never touch the disk again
+    class SourceManager {
+    public:
+        // maps the file at `path`, prints why and returns nothing if it cannot be read
+        std::optional<FileId> load(const std::string & path);
+
+        // registers an in memory buffer under `name`, the contents are copied
+        FileId add(const std::string & name, const std::string_view contents);
+
+        // replaces `length` bytes at `offset` of `file` by `text` in place, the file keeps its id and its locations,
+        // the cost depends on the size of the edit and its distance from the previous one but not on the size of
+        // the file, false and nothing changes if the range is not in the file or it would outgrow the locations left
+        //
+        // views into the file and locations in it from before the edit are invalidated
+        bool edit(const FileId file, const uint32_t offset, const uint32_t length, const std::string_view text);
+
+        const std::string & path(const FileId file) const;
+
+        // the whole file as one view, an edited file is made contiguous first, which costs the distance from its
+        // last edit to its end, so an edited file has to be read once before several threads read it
+        std::string_view buffer(const FileId file) const;
+
+        uint32_t size(const FileId file) const;
+
+        // appends bytes [begin, end) of `file` to `out`, without making an edited file contiguous
+        void copy(const FileId file, const uint32_t begin, const uint32_t end, std::string & out) const;
+
+        // 1 based line and column of a byte offset, O(log lines)
+        Position position(const FileId file, const uint32_t offset) const;
+        Position position(const SourceLoc location) const;
+
+        SourceLoc location(const FileId file, const uint32_t offset) const;
+
+        // file a location belongs to and its byte offset in there, O(log files)
+        FileId file(const SourceLoc location) const;
+        uint32_t offset(const SourceLoc location) const;
+
+        // text of a 1 based line without its newline, empty if out of range
+        std::string_view line(const FileId file, const uint64_t line) const;
+
+        uint32_t line_count(const FileId file) const;
+    private:
+        struct File {
+            std::string path;
+
+            // the file as it was loaded, its contents move to `text` on the first edit
+            std::unique_ptr<llvm::MemoryBuffer> buffer;
+            mutable GapArray<char> text; // the hole stays where the last edit happened
+
+            // the starts behind the hole are counted from the end of the file, so that an edit does not move them
+            GapArray<uint32_t> line_starts;
+
+            // locations reserved for the file, at least its size plus one so that its end has a location too
+            uint32_t span;
+
+            uint32_t size() const {
+                return buffer ? buffer->getBufferSize() : text.size();
+            }
+
+            uint32_t line_start(const uint32_t line) const {
+                return line < line_starts.gap() ? line_starts[line] : size() - line_starts[line];
+            }
+
+            // index of the first line starting behind `offset`, searched from the last edit
+            uint32_t upper_line(const uint32_t offset) const;
+        };
+
+        struct Span {
+            uint32_t base;
+            FileId file;
+        };
+
+        // deque so that references to paths stay valid while files are added
+        std::deque<File> files;
+
+        // first location of every file by id, and every span ordered by location for the reverse lookup
+        std::vector<uint32_t> bases;
+        std::vector<Span> spans;
+        uint32_t next_base = 1;
+
+        FileId insert(const std::string & path, std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+        // gives `file` a span for at least `size` bytes behind every other one, false if there is no room left
+        bool rebase(const FileId file, const uint32_t size);
+    };
+
+    // compiler wide source manager
+    SourceManager & source_manager();
+}
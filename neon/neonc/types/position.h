@@ -3,12 +3,13 @@
 #include <neonc.h>
 
 namespace neonc {
+    // 1 based line and column of a SourceLoc, only built for diagnostics
     struct Position {
-        Position(const uint64_t line, const uint64_t column): line(line), column(column) {}
+        Position(const uint32_t line, const uint32_t column): line(line), column(column) {}
 
         std::string string() const;
 
-        uint64_t line;
-        uint64_t column;
+        uint32_t line;
+        uint32_t column;
     };
 }
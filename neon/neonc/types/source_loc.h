@@ -0,0 +1,16 @@
+#pragma once
+
+#include <neonc.h>
+
+namespace neonc {
+    // a byte in one of the loaded source files, every file owns a range of locations in the source
+    // manager, so a single 32 bit value names both the file and the offset, line and column are only
+    // computed when a diagnostic is printed
+    struct SourceLoc {
+        uint32_t raw = 0; // 0 is reserved for nodes without a location
+
+        bool valid() const {
+            return raw != 0;
+        }
+    };
+}
@@ -0,0 +1,35 @@
+#include "symbol.h"
+
+namespace neonc {
+    std::string_view Symbol::name() const {
+        return interner().name(*this);
+    }
+
+    Interner::Interner() {
+        for (auto name : WELL_KNOWN_SYMBOLS)
+            intern(name);
+    }
+
+    Symbol Interner::intern(const std::string_view name) {
+        auto [it, inserted] = map.try_emplace(llvm::StringRef(name.data(), name.size()), names.size());
+
+        if (inserted)
+            names.push_back(std::string_view(it->getKey().data(), it->getKey().size()));
+
+        return Symbol { it->second };
+    }
+
+    std::string_view Interner::name(const Symbol symbol) const {
+        return names[symbol.id];
+    }
+
+    Interner & interner() {
+        static Interner instance;
+
+        return instance;
+    }
+
+    std::ostream & operator<<(std::ostream & os, const Symbol symbol) {
+        return os << symbol.name();
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <neonc.h>
+
+namespace neonc {
+    // interned name, two symbols are equal exactly when their names are
+    struct Symbol {
+        static constexpr uint32_t INVALID = std::numeric_limits<uint32_t>::max();
+
+        bool operator==(const Symbol & other) const = default;
+
+        bool valid() const {
+            return id != INVALID;
+        }
+
+        std::string_view name() const;
+
+        uint32_t id = INVALID;
+    };
+
+    // interned before anything else, in this order, so their ids are compile time constants
+    constexpr std::array<std::string_view, 15> WELL_KNOWN_SYMBOLS = {
+        "fn", "var", "true", "false", "return", "pub",
+        "main",
+        "bool", "i8", "i16", "i32", "i64", "f32", "f64", "str",
+    };
+
+    namespace symbol {
+        constexpr Symbol FN { 0 };
+        constexpr Symbol VAR { 1 };
+        constexpr Symbol TRUE { 2 };
+        constexpr Symbol FALSE { 3 };
+        constexpr Symbol RETURN { 4 };
+        constexpr Symbol PUB { 5 };
+
+        constexpr Symbol MAIN { 6 };
+
+        constexpr Symbol BOOL { 7 };
+        constexpr Symbol I8 { 8 };
+        constexpr Symbol I16 { 9 };
+        constexpr Symbol I32 { 10 };
+        constexpr Symbol I64 { 11 };
+        constexpr Symbol F32 { 12 };
+        constexpr Symbol F64 { 13 };
+        constexpr Symbol STR { 14 };
+    }
+
+    class Interner {
+    public:
+        Interner();
+
+        Symbol intern(const std::string_view name);
+        std::string_view name(const Symbol symbol) const;
+
+        uint32_t size() const {
+            return names.size();
+        }
+    private:
+        llvm::StringMap<uint32_t, llvm::BumpPtrAllocator> map;
+        std::vector<std::string_view> names; // views into the keys owned by `map`
+    };
+
+    // compiler wide interner, filled by the lexer
+    Interner & interner();
+
+    // dense map keyed by symbol id, lookups are a bounds check and an index, clearing only resets the
+    // entries in use, so a map reused for every function costs its own names and not the whole program
+    template<typename T>
+    class SymbolMap {
+    public:
+        bool contains(const Symbol symbol) const {
+            return symbol.id < values.size() && values[symbol.id].has_value();
+        }
+
+        T & operator[](const Symbol symbol) {
+            if (symbol.id >= values.size())
+                values.resize(symbol.id + 1);
+
+            if (!values[symbol.id]) {
+                values[symbol.id].emplace();
+                used.push_back(symbol.id);
+            }
+
+            return *values[symbol.id];
+        }
+
+        const T * find(const Symbol symbol) const {
+            return contains(symbol) ? &*values[symbol.id] : nullptr;
+        }
+
+        void clear() {
+            for (const auto id : used)
+                values[id].reset();
+
+            used.clear();
+        }
+
+        template<typename F>
+        void for_each(F && f) {
+            for (uint32_t i = 0; i < values.size(); i++)
+                if (values[i])
+                    f(Symbol { i }, *values[i]);
+        }
+    private:
+        std::vector<std::optional<T>> values;
+        std::vector<uint32_t> used; // ids with a value
+    };
+
+    std::ostream & operator<<(std::ostream & os, const Symbol symbol);
+}
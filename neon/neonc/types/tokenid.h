@@ -3,7 +3,7 @@
 #include <neonc.h>
 
 namespace neonc {
-    enum class TokenId {
+    enum class TokenId : uint8_t {
         ENDOFFILE,
 
         INVALID,
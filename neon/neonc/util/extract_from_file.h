@@ -1,7 +0,0 @@
-#pragma once
-
-#include <neonc.h>
-
-namespace neonc {
-    const std::string extract_from_file(const std::string file_path, int line);
-}
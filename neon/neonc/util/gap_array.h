@@ -0,0 +1,222 @@
+#pragma once
+
+#include <neonc.h>
+
+namespace neonc {
+    // array with a hole that can be moved around, inserting and erasing at the hole costs what it costs at the
+    // end of a vector and moving the hole costs the distance it moves, so a run of edits close to each other
+    // never touches the rest of the array, with the hole at the end it is a plain vector
+    template<typename T>
+    class GapArray {
+    public:
+        uint32_t size() const {
+            return data.size() - gap_size;
+        }
+
+        // index of the first element behind the hole, elements [0, gap()) are in front of it
+        uint32_t gap() const {
+            return gap_begin;
+        }
+
+        const T & operator[](const uint32_t index) const {
+            return data[index < gap_begin ? index : index + gap_size];
+        }
+
+        T & operator[](const uint32_t index) {
+            return data[index < gap_begin ? index : index + gap_size];
+        }
+
+        // moves the hole in front of `index`, every element that crosses it is replaced by `moved(element)`
+        template<typename F>
+        void move_gap(const uint32_t index, F && moved) {
+            if (index < gap_begin) {
+                for (uint32_t i = gap_begin; i-- > index;)
+                    data[i + gap_size] = moved(data[i]);
+            } else {
+                for (uint32_t i = gap_begin; i < index; i++)
+                    data[i] = moved(data[i + gap_size]);
+            }
+
+            gap_begin = index;
+        }
+
+        void move_gap(const uint32_t index) {
+            if (index < gap_begin) {
+                std::move_backward(data.begin() + index, data.begin() + gap_begin, data.begin() + gap_begin + gap_size);
+            } else {
+                std::move(data.begin() + gap_begin + gap_size, data.begin() + index + gap_size, data.begin() + gap_begin);
+            }
+
+            gap_begin = index;
+        }
+
+        // drops the `count` elements behind the hole
+        void erase(const uint32_t count) {
+            gap_size += count;
+        }
+
+        // inserts in front of the hole
+        void insert(const T & value) {
+            reserve_gap(1);
+
+            data[gap_begin++] = value;
+            gap_size--;
+        }
+
+        template<typename It>
+        void insert(It first, It last) {
+            const uint32_t count = std::distance(first, last);
+
+            reserve_gap(count);
+
+            std::copy(first, last, data.begin() + gap_begin);
+            gap_begin += count;
+            gap_size -= count;
+        }
+
+        // copies the elements [begin, end) to `out` without moving the hole
+        template<typename Out>
+        void copy(const uint32_t begin, const uint32_t end, Out out) const {
+            const auto split = std::clamp(gap_begin, begin, end);
+
+            out = std::copy(data.begin() + begin, data.begin() + split, out);
+            std::copy(data.begin() + split + gap_size, data.begin() + end + gap_size, out);
+        }
+
+        // the elements as one range, the hole is moved behind the last one first, nothing is written if it
+        // is there already, so threads can share an array made contiguous beforehand
+        T * contiguous() {
+            if (gap_begin != size())
+                move_gap(size());
+
+            return data.data();
+        }
+
+        bool is_contiguous() const {
+            return gap_size == 0 || gap_begin == size();
+        }
+
+        bool has_gap() const {
+            return gap_size != 0;
+        }
+
+        // removes the hole, the array is a plain vector again
+        void close() {
+            contiguous();
+
+            data.resize(size());
+            gap_size = 0;
+        }
+
+        // appends like a vector does, the array must not have a hole, see `close`
+        void push_back(const T & value) {
+            data.push_back(value);
+            gap_begin = data.size();
+        }
+
+        void pop_back() {
+            contiguous();
+
+            gap_begin--;
+            gap_size++;
+        }
+
+        // drops the first `count` elements
+        void erase_front(const uint32_t count) {
+            contiguous();
+
+            data.erase(data.begin(), data.begin() + count);
+            gap_begin -= count;
+        }
+
+        void reserve(const std::size_t count) {
+            data.reserve(count + gap_size);
+        }
+
+        void resize(const std::size_t count) {
+            contiguous();
+
+            data.resize(size());
+            data.resize(count);
+            gap_begin = count;
+            gap_size = 0;
+        }
+
+        void clear() {
+            data.clear();
+            gap_begin = 0;
+            gap_size = 0;
+        }
+
+        // makes room for `count` more elements in the hole, the array at least doubles so that a long run
+        // of inserts stays amortized constant per element
+        void reserve_gap(const uint32_t count) {
+            if (gap_size >= count)
+                return;
+
+            const std::size_t elements = size();
+            const std::size_t capacity = std::max<std::size_t>(elements * 2, elements + count + 16);
+
+            std::vector<T> grown(capacity);
+
+            std::move(data.begin(), data.begin() + gap_begin, grown.begin());
+            std::move(data.begin() + gap_begin + gap_size, data.end(), grown.begin() + capacity - (elements - gap_begin));
+
+            data = std::move(grown);
+            gap_size = capacity - elements;
+        }
+    private:
+        std::vector<T> data;
+
+        uint32_t gap_begin = 0;
+        uint32_t gap_size = 0;
+    };
+
+    // partition point of `pred` over [0, size), searched outwards from `hint`, which costs the log of the distance
+    // to the result instead of the log of the size and stays in the cache lines around the hint
+    template<typename F>
+    uint32_t partition_near(const uint32_t size, const uint32_t hint, F && pred) {
+        uint32_t low = 0;
+        uint32_t high = size;
+
+        if (hint < size && pred(hint)) {
+            low = hint + 1;
+
+            for (uint32_t step = 1; low < high; step *= 2) {
+                const uint32_t probe = low + std::min(step, high - low) - 1;
+
+                if (!pred(probe)) {
+                    high = probe;
+                    break;
+                }
+
+                low = probe + 1;
+            }
+        } else {
+            high = std::min(hint, size);
+
+            for (uint32_t step = 1; low < high; step *= 2) {
+                const uint32_t probe = high - std::min(step, high - low);
+
+                if (pred(probe)) {
+                    low = probe + 1;
+                    break;
+                }
+
+                high = probe;
+            }
+        }
+
+        while (low < high) {
+            const uint32_t middle = low + (high - low) / 2;
+
+            if (pred(middle)) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        return low;
+    }
+}
@@ -10,9 +10,9 @@ namespace neonc {
         time = std::chrono::steady_clock::now();
     }
 
-    void Measure::finish(std::string msg) const {
+    void Measure::finish(std::string msg, std::ostream & out) const {
         auto end = std::chrono::steady_clock::now();
 
-        std::cout << msg << " " << std::chrono::duration_cast<std::chrono::milliseconds>(end - time).count() << " ms" << std::endl;
+        out << msg << " " << std::chrono::duration_cast<std::chrono::milliseconds>(end - time).count() << " ms" << std::endl;
     }
 }
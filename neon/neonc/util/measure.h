@@ -10,6 +10,6 @@ namespace neonc {
         Measure();
 
         void reset();
-        void finish(std::string msg) const;
+        void finish(std::string msg, std::ostream & out = std::cout) const;
     };
 }
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <neonc.h>
+
+namespace neonc {
+    // runs f(0) .. f(count - 1), each on its own thread, f(0) on the calling one
+    template<typename F>
+    void parallel_for(const uint32_t count, F && f) {
+        std::vector<std::thread> threads;
+        threads.reserve(count);
+
+        for (uint32_t i = 1; i < count; i++)
+            threads.emplace_back([&f, i] { f(i); });
+
+        if (count > 0)
+            f(0);
+
+        for (auto & thread : threads)
+            thread.join();
+    }
+}
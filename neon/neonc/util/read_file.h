@@ -1,7 +0,0 @@
-#pragma once
-
-#include <neonc.h>
-
-namespace neonc {
-    std::string read_file(std::string file_path);
-}